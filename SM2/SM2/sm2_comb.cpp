@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cstdio>
+#include <random>
+#include <chrono>
+#include "sm2_comb.h"
+
+using namespace sm2;
+
+static U256 random_scalar(std::mt19937_64& gen) {
+    U256 k;
+    do {
+        for (auto& w : k.w) w = gen();
+    } while (!less(k, N) || is_zero(k));
+    return k;
+}
+
+int main() {
+    std::mt19937_64 gen(2024);
+
+    // 建表耗时(只在第一次使用时发生)
+    auto start = std::chrono::steady_clock::now();
+    comb_table();
+    double buildSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("建表: %.1f us, 表大小 %zu 字节\n", buildSec * 1e6, sizeof(CombTable));
+
+    // 与逐比特倍点-加比较, 包括边界标量
+    U256 one{{1, 0, 0, 0}}, n1, all;
+    sub(n1, N, one);
+    for (auto& w : all.w) w = ~0ull;
+    U256 edge[] = {U256{}, one, n1, N, all};
+    int failures = 0;
+    for (auto& k : edge) {
+        JPoint a = point_mul_base(k), b = point_mul_binary(k, G_AFFINE);
+        if (!point_equal(to_affine(a), to_affine(b))) ++failures;
+    }
+    for (int i = 0; i < 500; ++i) {
+        U256 k = random_scalar(gen);
+        if (!point_equal(to_affine(point_mul_base(k)), to_affine(point_mul_binary(k, G_AFFINE)))) ++failures;
+    }
+    printf("与倍点-加比较: %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // 吞吐
+    const int rounds = 2000;
+    U256 k = random_scalar(gen);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        JPoint r = point_mul_binary(k, G_AFFINE);
+        k.w[0] ^= r.X.w[0] & 1;
+    }
+    double binSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        JPoint r = point_mul_base(k);
+        k.w[0] ^= r.X.w[0] & 1;
+    }
+    double combSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds;
+    printf("kG 倍点-加: %7.1f us\n", binSec * 1e6);
+    printf("kG 梳形表:  %7.1f us  (%.1fx)\n", combSec * 1e6, binSec / combSec);
+    return 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+// 基点G的固定基标量乘法(梳形/comb方法), 用于密钥生成、签名和加密里的kG.
+//
+// 把256位标量排成COMB_TEETH行、COMB_SPACING列: 第t行第j列是第t·D + j比特(D = 43).
+// 第j列的6个比特组成下标m, 表项 T[m] = Σ{t: m的第t位为1} 2^(tD)·G, 则
+//   kG = Σ_j 2^j · T[第j列]
+// 再把列分成两半, 第二张表是第一张乘以2^22, 同一轮倍点里两半各加一次:
+//   21次倍点 + 43次混合加法, 而普通的倍点-加约要256次倍点 + 128次加法.
+//
+// 两张表共128个仿射点, 每个点64字节正好一条缓存行, 一共8KB, 常驻L1.
+// 第一次使用时用Jacobian坐标算出, 最后一次求逆批量转成仿射坐标.
+// 查表时扫描整张表, 用掩码选出需要的项, 访存模式与标量无关.
+
+#include <cstdint>
+#include <cstddef>
+#include "sm2_point.h"
+
+namespace sm2 {
+
+constexpr int COMB_TEETH = 6;
+constexpr int COMB_SPACING = 43; // ceil(256 / 6)
+constexpr int COMB_HALF = 22;    // 第二张表负责的列偏移
+constexpr int COMB_ENTRIES = 1 << COMB_TEETH;
+
+struct alignas(64) CombEntry {
+    APoint p;
+};
+
+struct CombTable {
+    CombEntry t[2][COMB_ENTRIES];
+};
+
+inline CombTable build_comb_table() {
+    // base[t] = 2^(tD)·G, base2[t] = 2^(tD + 22)·G
+    JPoint base[2][COMB_TEETH];
+    JPoint acc = to_jacobian(G_AFFINE);
+    for (int t = 0; t < COMB_TEETH; ++t) {
+        base[0][t] = acc;
+        for (int i = 0; i < COMB_SPACING; ++i) {
+            if (i == COMB_HALF) base[1][t] = acc;
+            point_double(acc, acc);
+        }
+    }
+
+    // 按下标递推: T[m] = T[m去掉最高位] + base[最高位]
+    JPoint jac[2 * COMB_ENTRIES];
+    for (int h = 0; h < 2; ++h) {
+        JPoint* row = jac + h * COMB_ENTRIES;
+        row[0] = INFINITY_POINT;
+        for (int m = 1; m < COMB_ENTRIES; ++m) {
+            int top = 31 - __builtin_clz((unsigned)m);
+            point_add(row[m], row[m ^ (1 << top)], base[h][top]);
+        }
+    }
+
+    CombTable table;
+    APoint affine[2 * COMB_ENTRIES];
+    U256 scratch[2 * COMB_ENTRIES];
+    batch_to_affine(affine, jac, 2 * COMB_ENTRIES, scratch);
+    for (int i = 0; i < 2 * COMB_ENTRIES; ++i) table.t[i / COMB_ENTRIES][i % COMB_ENTRIES].p = affine[i];
+    return table;
+}
+
+// 第一次调用时构建, 之后只读
+inline const CombTable& comb_table() {
+    static const CombTable table = build_comb_table();
+    return table;
+}
+
+// 常数时间查表: 每一项都读, 只有下标相等的那一项被选中
+inline void comb_lookup(APoint& r, const CombEntry* row, unsigned idx) {
+    U256 x{}, y{};
+    for (unsigned i = 0; i < COMB_ENTRIES; ++i) {
+        uint64_t d = i ^ idx;
+        uint64_t mask = ((d | (0 - d)) >> 63) - 1;
+        for (int w = 0; w < 4; ++w) {
+            x.w[w] |= row[i].p.x.w[w] & mask;
+            y.w[w] |= row[i].p.y.w[w] & mask;
+        }
+    }
+    r.x = x;
+    r.y = y;
+}
+
+// 第j列的6个比特, 超出256位的比特为0(只与公开的j有关)
+inline unsigned comb_column(const U256& k, int j) {
+    unsigned idx = 0;
+    for (int t = 0; t < COMB_TEETH; ++t) {
+        int bit = t * COMB_SPACING + j;
+        if (bit < 256) idx |= (unsigned)((k.w[bit / 64] >> (bit % 64)) & 1) << t;
+    }
+    return idx;
+}
+
+// k·G, k为普通整数(不要求小于n). 常数时间
+inline JPoint point_mul_base(const U256& k) {
+    const CombTable& table = comb_table();
+    JPoint r = INFINITY_POINT;
+    APoint q{};
+    for (int j = COMB_HALF - 1; j >= 0; --j) {
+        point_double(r, r);
+        if (j + COMB_HALF < COMB_SPACING) {
+            comb_lookup(q, table.t[1], comb_column(k, j + COMB_HALF));
+            point_add_mixed(r, r, q);
+        }
+        comb_lookup(q, table.t[0], comb_column(k, j));
+        point_add_mixed(r, r, q);
+    }
+    return r;
+}
+
+} // namespace sm2
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cstdio>
+#include <random>
+#include <chrono>
+#include "sm2_field.h"
+
+using namespace sm2;
+
+// 常数在编译期就已算好
+static_assert(equal(fp_from_mont(FP_ONE), U256{{1, 0, 0, 0}}), "FP_ONE");
+static_assert(equal(fn_from_mont(FN_ONE), U256{{1, 0, 0, 0}}), "FN_ONE");
+static_assert(FN_N0 * N.w[0] == (uint64_t)-1, "FN_N0");
+
+static void print(const char* label, const U256& a) {
+    uint8_t b[32];
+    to_bytes(b, a);
+    printf("%s", label);
+    for (uint8_t x : b) printf("%02X", x);
+    printf("\n");
+}
+
+static U256 random_below(std::mt19937_64& gen, const U256& m) {
+    U256 r;
+    do {
+        for (auto& w : r.w) w = gen();
+    } while (!less(r, m));
+    return r;
+}
+
+int main() {
+    // 基点满足曲线方程 y^2 = x^3 + ax + b
+    U256 y2, x3, t;
+    fp_sqr(y2, GY_MONT);
+    fp_sqr(x3, GX_MONT);
+    fp_mul(x3, x3, GX_MONT);
+    fp_mul(t, A_MONT, GX_MONT);
+    fp_add(x3, x3, t);
+    fp_add(x3, x3, B_MONT);
+    printf("G在曲线上: %s\n", equal(y2, x3) ? "是" : "否!");
+    print("Gx = ", fp_from_mont(GX_MONT));
+
+    // 求逆与模n运算的自检
+    std::mt19937_64 gen(2024);
+    int failures = 0;
+    for (int i = 0; i < 1000; ++i) {
+        U256 a = fp_to_mont(random_below(gen, P)), inv, prod;
+        fp_inv(inv, a);
+        fp_mul(prod, a, inv);
+        if (!is_zero(a) && !equal(prod, FP_ONE)) ++failures;
+        U256 k = fn_to_mont(random_below(gen, N));
+        fn_inv(inv, k);
+        fn_mul(prod, k, inv);
+        if (!is_zero(k) && !equal(prod, FN_ONE)) ++failures;
+    }
+    printf("求逆自检: %s\n", failures == 0 ? "通过" : "失败!");
+
+    // 吞吐: 每次的结果都是下一次的输入, 最后打印出来, 编译器不能省掉循环
+    const int rounds = 2000000;
+    U256 a = fp_to_mont(random_below(gen, P)), b = fp_to_mont(random_below(gen, P));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) fp_mul(a, a, b);
+    double mulSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    U256 s = fp_to_mont(random_below(gen, P));
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) fp_sqr(s, s);
+    double sqrSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    U256 c = fn_to_mont(random_below(gen, N)), d = fn_to_mont(random_below(gen, N));
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) fn_mul(c, c, d);
+    double fnSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("模p乘法:  %6.1f ns  (模n乘法的%.2f倍速度)\n", mulSec / rounds * 1e9, fnSec / mulSec);
+    printf("模p平方:  %6.1f ns\n", sqrSec / rounds * 1e9);
+    printf("模n乘法:  %6.1f ns\n", fnSec / rounds * 1e9);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10000; ++i) fp_inv(b, b);
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("模p求逆:  %6.2f us\n", sec / 10000 * 1e6);
+    fp_add(a, a, s);
+    fp_add(a, a, b);
+    print("(校验) ", a);
+    print("(校验) ", c);
+    return 0;
+}
@@ -0,0 +1,441 @@
+#pragma once
+
+// SM2推荐曲线的256位定长域运算, 4个64位limb(小端), 不依赖大数库.
+//
+// 模p: p = 2^256 - 2^224 - 2^96 + 2^64 - 1. 元素保存为Montgomery形式 aR mod p (R = 2^256).
+//   因为p ≡ -1 (mod 2^64), 每轮约简的商m就是当前最低limb, 不需要乘法;
+//   m·p / 2^64 又等于 m·(2^192 - 2^160 - 2^32 + 1), 只用移位和加减即可.
+//   模乘按CIOS顺序把16次64位乘法与4轮只有加减的约简交错进行; 平方只需10次乘法, 算完乘积再约简.
+//   加减链在x86-64上用adc/sbb, 模p乘法比同样是4 limb的模n乘法快.
+// 模n(基点的阶): 通用的CIOS Montgomery乘法, n0 = -n^-1 mod 2^64在编译期算出.
+//
+// 所有运算都是常数时间的: 条件减法用掩码选择, 求逆用指数固定的费马小定理.
+// 函数都是constexpr, 曲线常数的Montgomery形式(以及之后的预计算表)可以在编译期生成.
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SM2_FIELD_X64 1
+#include <x86intrin.h>
+#endif
+
+namespace sm2 {
+
+typedef unsigned __int128 u128;
+
+// 256位整数, w[0]为最低limb
+struct U256 {
+    uint64_t w[4];
+};
+
+// 大端32字节 <-> U256
+constexpr U256 from_bytes(const uint8_t in[32]) {
+    U256 r{};
+    for (int i = 0; i < 4; ++i) {
+        uint64_t v = 0;
+        for (int j = 0; j < 8; ++j) v = (v << 8) | in[(3 - i) * 8 + j];
+        r.w[i] = v;
+    }
+    return r;
+}
+
+inline void to_bytes(uint8_t out[32], const U256& a) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 8; ++j) out[(3 - i) * 8 + j] = (uint8_t)(a.w[i] >> (56 - 8 * j));
+    }
+}
+
+// 十六进制常数, 只用于编译期
+constexpr U256 from_hex(const char* hex) {
+    U256 r{};
+    for (int i = 0; i < 64; ++i) {
+        char c = hex[i];
+        uint64_t d = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+        int limb = (63 - i) / 16;
+        r.w[limb] = (r.w[limb] << 4) | d;
+    }
+    return r;
+}
+
+// ---------------------------------------------------------------- 256位整数
+
+// r = a + b, 返回进位
+constexpr uint64_t add(U256& r, const U256& a, const U256& b) {
+    u128 c = 0;
+    for (int i = 0; i < 4; ++i) {
+        c += (u128)a.w[i] + b.w[i];
+        r.w[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    return (uint64_t)c;
+}
+
+// r = a - b, 返回借位
+constexpr uint64_t sub(U256& r, const U256& a, const U256& b) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; ++i) {
+        u128 d = (u128)a.w[i] - b.w[i] - borrow;
+        r.w[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    return borrow;
+}
+
+// mask为全1时r = a, 为0时r = b
+constexpr void select(U256& r, uint64_t mask, const U256& a, const U256& b) {
+    for (int i = 0; i < 4; ++i) r.w[i] = (a.w[i] & mask) | (b.w[i] & ~mask);
+}
+
+constexpr bool is_zero(const U256& a) {
+    return (a.w[0] | a.w[1] | a.w[2] | a.w[3]) == 0;
+}
+
+constexpr bool equal(const U256& a, const U256& b) {
+    return ((a.w[0] ^ b.w[0]) | (a.w[1] ^ b.w[1]) | (a.w[2] ^ b.w[2]) | (a.w[3] ^ b.w[3])) == 0;
+}
+
+// a < b
+constexpr bool less(const U256& a, const U256& b) {
+    U256 t{};
+    return sub(t, a, b) != 0;
+}
+
+// 64位的带进位加法/带借位减法, carry/borrow为0或1, 输出新的进位/借位.
+// 运行时在x86-64上用adc/sbb指令(GCC 12不会把比较得到的进位链合成adc), 编译期求值和其他平台用比较
+constexpr uint64_t addc(uint64_t a, uint64_t b, uint64_t& carry) {
+#ifdef SM2_FIELD_X64
+    if (!__builtin_is_constant_evaluated()) {
+        unsigned long long r = 0;
+        carry = _addcarry_u64((unsigned char)carry, a, b, &r);
+        return r;
+    }
+#endif
+    uint64_t s = a + b;
+    uint64_t c = s < a;
+    uint64_t r = s + carry;
+    carry = c | (r < s);
+    return r;
+}
+
+constexpr uint64_t subb(uint64_t a, uint64_t b, uint64_t& borrow) {
+#ifdef SM2_FIELD_X64
+    if (!__builtin_is_constant_evaluated()) {
+        unsigned long long r = 0;
+        borrow = _subborrow_u64((unsigned char)borrow, a, b, &r);
+        return r;
+    }
+#endif
+    uint64_t d = a - b;
+    uint64_t c = a < b;
+    uint64_t r = d - borrow;
+    borrow = c | (d < borrow);
+    return r;
+}
+
+// 64x64 -> 128位乘积, 返回低64位, 高64位写入hi
+constexpr uint64_t mul64(uint64_t a, uint64_t b, uint64_t& hi) {
+    u128 p = (u128)a * b;
+    hi = (uint64_t)(p >> 64);
+    return (uint64_t)p;
+}
+
+// 带进位x + carry(最多一位)后, 若超出模数m则减去m; 输入须小于2m
+constexpr void reduce_once(U256& r, uint64_t carry, const U256& x, const U256& m) {
+    U256 t{};
+    uint64_t borrow = sub(t, x, m);
+    // carry为1或没有借位时用t
+    uint64_t useT = 0 - (carry | (borrow ^ 1));
+    select(r, useT, t, x);
+}
+
+// ---------------------------------------------------------------- 模p
+
+inline constexpr U256 P = from_hex("FFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF00000000FFFFFFFFFFFFFFFF");
+
+// t[0..7]为小于p·R的数, 返回t/R mod p.
+// 先只约简低半部分: 每轮m = 最低limb, (acc + m·p)/2^64 = acc/2^64 + m·(2^192 + 1) - m·2^32·(2^128 + 1).
+// acc/2^64不到2^192, 加上后不会超过2^256, 所以每轮只是一条4 limb的加法链和一条减法链, 没有向外的进位.
+// 4轮后得到(t_lo + M·p)/R <= p, 再加上高半部分t_hi(< p), 最后条件减一次p
+constexpr void fp_reduce(U256& r, const uint64_t t[8]) {
+    uint64_t a0 = t[0], a1 = t[1], a2 = t[2], a3 = t[3];
+    #pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i) {
+        uint64_t m = a0, lo = m << 32, hi = m >> 32, c = 0;
+        // [a1, a2, a3, 0] + [m, 0, 0, m] - [lo, hi, lo, hi]
+        a0 = addc(a1, m, c);
+        a1 = addc(a2, 0, c);
+        a2 = addc(a3, 0, c);
+        a3 = m + c;
+        c = 0;
+        a0 = subb(a0, lo, c);
+        a1 = subb(a1, hi, c);
+        a2 = subb(a2, lo, c);
+        a3 = subb(a3, hi, c);
+    }
+    uint64_t c = 0;
+    U256 x{};
+    x.w[0] = addc(a0, t[4], c);
+    x.w[1] = addc(a1, t[5], c);
+    x.w[2] = addc(a2, t[6], c);
+    x.w[3] = addc(a3, t[7], c);
+    reduce_once(r, c, x, P);
+}
+
+// 乘法与约简交错(与fn_mul相同的CIOS顺序): 每加上一行a·b_i就做一轮约简, 累加值始终小于2p, 只占5个limb.
+// 约简一轮不需要乘法, 比fn_mul每轮少4次64位乘法. 进位/借位链用64位的addc/subb写,
+// GCC对一长串u128加减会把中间值溢出到栈上
+constexpr void fp_mul(U256& r, const U256& a, const U256& b) {
+    uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+    #pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i) {
+        uint64_t bi = b.w[i], hi0 = 0, hi1 = 0, hi2 = 0, hi3 = 0;
+        uint64_t p0 = mul64(a.w[0], bi, hi0), p1 = mul64(a.w[1], bi, hi1);
+        uint64_t p2 = mul64(a.w[2], bi, hi2), p3 = mul64(a.w[3], bi, hi3);
+        // t += [p0, p1 + hi0, p2 + hi1, p3 + hi2, hi3]
+        uint64_t c = 0;
+        p1 = addc(p1, hi0, c);
+        p2 = addc(p2, hi1, c);
+        p3 = addc(p3, hi2, c);
+        hi3 += c;
+        c = 0;
+        t0 = addc(t0, p0, c);
+        t1 = addc(t1, p1, c);
+        t2 = addc(t2, p2, c);
+        t3 = addc(t3, p3, c);
+        t4 = addc(t4, hi3, c);
+        uint64_t t5 = c;
+
+        // (t + m·p)/2^64 = [t1, t2, t3, t4, t5] + [m, 0, 0, m] - [lo, hi, lo, hi]
+        uint64_t m = t0, lo = m << 32, hi = m >> 32;
+        c = 0;
+        t0 = addc(t1, m, c);
+        t1 = addc(t2, 0, c);
+        t2 = addc(t3, 0, c);
+        t3 = addc(t4, m, c);
+        t4 = t5 + c;
+        c = 0;
+        t0 = subb(t0, lo, c);
+        t1 = subb(t1, hi, c);
+        t2 = subb(t2, lo, c);
+        t3 = subb(t3, hi, c);
+        t4 -= c;
+    }
+    U256 x{{t0, t1, t2, t3}};
+    reduce_once(r, t4, x, P);
+}
+
+// 平方: 交叉项a_i·a_j(i < j)只算一次再整体左移一位, 加上对角项a_i^2; 10次64位乘法, 模乘是16次
+constexpr void fp_sqr(U256& r, const U256& a) {
+    uint64_t t[8] = {};
+    uint64_t h01 = 0, h02 = 0, h03 = 0, h12 = 0, h13 = 0, h23 = 0;
+    uint64_t l01 = mul64(a.w[0], a.w[1], h01), l02 = mul64(a.w[0], a.w[2], h02);
+    uint64_t l03 = mul64(a.w[0], a.w[3], h03), l12 = mul64(a.w[1], a.w[2], h12);
+    uint64_t l13 = mul64(a.w[1], a.w[3], h13), l23 = mul64(a.w[2], a.w[3], h23);
+
+    // 交叉项之和: a0·(a1, a2, a3)·2^64 + a1·(a2, a3)·2^192 + a2·a3·2^320, 小于2^448
+    uint64_t c = 0;
+    uint64_t t1 = l01;
+    uint64_t t2 = addc(h01, l02, c);
+    uint64_t t3 = addc(h02, l03, c);
+    uint64_t t4 = h03 + c;
+    c = 0;
+    uint64_t x4 = addc(h12, l13, c);
+    uint64_t t5 = h13 + c;
+    c = 0;
+    t3 = addc(t3, l12, c);
+    t4 = addc(t4, x4, c);
+    t5 = addc(t5, l23, c);
+    uint64_t t6 = h23 + c;
+
+    // 乘2
+    uint64_t t7 = t6 >> 63;
+    t6 = (t6 << 1) | (t5 >> 63);
+    t5 = (t5 << 1) | (t4 >> 63);
+    t4 = (t4 << 1) | (t3 >> 63);
+    t3 = (t3 << 1) | (t2 >> 63);
+    t2 = (t2 << 1) | (t1 >> 63);
+    t1 <<= 1;
+
+    // 加上对角项
+    uint64_t d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+    t[0] = mul64(a.w[0], a.w[0], d0);
+    uint64_t e1 = mul64(a.w[1], a.w[1], d1);
+    uint64_t e2 = mul64(a.w[2], a.w[2], d2);
+    uint64_t e3 = mul64(a.w[3], a.w[3], d3);
+    c = 0;
+    t[1] = addc(t1, d0, c);
+    t[2] = addc(t2, e1, c);
+    t[3] = addc(t3, d1, c);
+    t[4] = addc(t4, e2, c);
+    t[5] = addc(t5, d2, c);
+    t[6] = addc(t6, e3, c);
+    t[7] = addc(t7, d3, c);
+    fp_reduce(r, t);
+}
+
+constexpr void fp_add(U256& r, const U256& a, const U256& b) {
+    U256 s{};
+    uint64_t c = add(s, a, b);
+    reduce_once(r, c, s, P);
+}
+
+constexpr void fp_sub(U256& r, const U256& a, const U256& b) {
+    U256 d{}, t{};
+    uint64_t borrow = sub(d, a, b);
+    add(t, d, P);
+    select(r, 0 - borrow, t, d);
+}
+
+constexpr void fp_neg(U256& r, const U256& a) {
+    U256 zero{};
+    fp_sub(r, zero, a);
+}
+
+// R^2 mod p, 由R mod p = 2^256 - p连续倍加256次得到
+constexpr U256 fp_r2() {
+    U256 r{}, zero{};
+    sub(r, zero, P);
+    for (int i = 0; i < 256; ++i) fp_add(r, r, r);
+    return r;
+}
+
+inline constexpr U256 FP_R2 = fp_r2();
+
+constexpr U256 fp_to_mont(const U256& a) {
+    U256 r{};
+    fp_mul(r, a, FP_R2);
+    return r;
+}
+
+constexpr U256 fp_from_mont(const U256& a) {
+    U256 r{}, one{{1, 0, 0, 0}};
+    fp_mul(r, a, one);
+    return r;
+}
+
+inline constexpr U256 FP_ONE = fp_to_mont(U256{{1, 0, 0, 0}});
+
+// r = a^e, e为公开的固定指数
+constexpr void fp_pow(U256& r, const U256& a, const U256& e) {
+    U256 acc = FP_ONE;
+    for (int i = 255; i >= 0; --i) {
+        fp_sqr(acc, acc);
+        if ((e.w[i / 64] >> (i % 64)) & 1) fp_mul(acc, acc, a);
+    }
+    r = acc;
+}
+
+// a^(p-2); a为0时结果为0
+constexpr void fp_inv(U256& r, const U256& a) {
+    U256 e{}, two{{2, 0, 0, 0}};
+    sub(e, P, two);
+    fp_pow(r, a, e);
+}
+
+// ---------------------------------------------------------------- 模n
+
+inline constexpr U256 N = from_hex("FFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFF7203DF6B21C6052B53BBF40939D54123");
+
+// -n^-1 mod 2^64, 牛顿迭代
+constexpr uint64_t fn_n0() {
+    uint64_t n = N.w[0], x = 1;
+    for (int i = 0; i < 6; ++i) x *= 2 - n * x;
+    return 0 - x;
+}
+
+inline constexpr uint64_t FN_N0 = fn_n0();
+
+// CIOS Montgomery乘法: r = a·b/R mod n, a和b须小于n
+constexpr void fn_mul(U256& r, const U256& a, const U256& b) {
+    uint64_t t[6] = {};
+    for (int i = 0; i < 4; ++i) {
+        u128 c = 0;
+        for (int j = 0; j < 4; ++j) {
+            c += (u128)a.w[j] * b.w[i] + t[j];
+            t[j] = (uint64_t)c;
+            c >>= 64;
+        }
+        c += t[4];
+        t[4] = (uint64_t)c;
+        t[5] = (uint64_t)(c >> 64);
+
+        uint64_t m = t[0] * FN_N0;
+        c = (u128)m * N.w[0] + t[0];
+        c >>= 64;
+        for (int j = 1; j < 4; ++j) {
+            c += (u128)m * N.w[j] + t[j];
+            t[j - 1] = (uint64_t)c;
+            c >>= 64;
+        }
+        c += t[4];
+        t[3] = (uint64_t)c;
+        t[4] = t[5] + (uint64_t)(c >> 64);
+    }
+    U256 x{{t[0], t[1], t[2], t[3]}};
+    reduce_once(r, t[4], x, N);
+}
+
+constexpr void fn_add(U256& r, const U256& a, const U256& b) {
+    U256 s{};
+    uint64_t c = add(s, a, b);
+    reduce_once(r, c, s, N);
+}
+
+constexpr void fn_sub(U256& r, const U256& a, const U256& b) {
+    U256 d{}, t{};
+    uint64_t borrow = sub(d, a, b);
+    add(t, d, N);
+    select(r, 0 - borrow, t, d);
+}
+
+constexpr U256 fn_r2() {
+    U256 r{}, zero{};
+    sub(r, zero, N);
+    for (int i = 0; i < 256; ++i) fn_add(r, r, r);
+    return r;
+}
+
+inline constexpr U256 FN_R2 = fn_r2();
+
+constexpr U256 fn_to_mont(const U256& a) {
+    U256 r{};
+    fn_mul(r, a, FN_R2);
+    return r;
+}
+
+constexpr U256 fn_from_mont(const U256& a) {
+    U256 r{}, one{{1, 0, 0, 0}};
+    fn_mul(r, a, one);
+    return r;
+}
+
+inline constexpr U256 FN_ONE = fn_to_mont(U256{{1, 0, 0, 0}});
+
+// 任意256位整数模n(2^256 < 2n, 最多减一次)
+constexpr U256 fn_reduce(const U256& a) {
+    U256 r{};
+    reduce_once(r, 0, a, N);
+    return r;
+}
+
+// Montgomery形式下的a^(n-2)
+constexpr void fn_inv(U256& r, const U256& a) {
+    U256 e{}, two{{2, 0, 0, 0}};
+    sub(e, N, two);
+    U256 acc = FN_ONE;
+    for (int i = 255; i >= 0; --i) {
+        fn_mul(acc, acc, acc);
+        if ((e.w[i / 64] >> (i % 64)) & 1) fn_mul(acc, acc, a);
+    }
+    r = acc;
+}
+
+// ---------------------------------------------------------------- 曲线常数(模p的Montgomery形式)
+
+inline constexpr U256 A_MONT = fp_to_mont(from_hex("FFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF00000000FFFFFFFFFFFFFFFC"));
+inline constexpr U256 B_MONT = fp_to_mont(from_hex("28E9FA9E9D9F5E344D5A9E4BCF6509A7F39789F515AB8F92DDBCBD414D940E93"));
+inline constexpr U256 GX_MONT = fp_to_mont(from_hex("32C4AE2C1F1981195F9904466A39C9948FE30BBFF2660BE1715A4589334C74C7"));
+inline constexpr U256 GY_MONT = fp_to_mont(from_hex("BC3736A2F4F6779C59BDCEE36B692153D0A9877CC62A474002DF32E52139F0A0"));
+
+} // namespace sm2
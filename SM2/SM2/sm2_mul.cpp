@@ -0,0 +1,81 @@
+#include <iostream>
+#include <cstdio>
+#include <random>
+#include <chrono>
+#include "sm2_comb.h"
+#include "sm2_mul.h"
+
+using namespace sm2;
+
+static U256 random_scalar(std::mt19937_64& gen) {
+    U256 k;
+    do {
+        for (auto& w : k.w) w = gen();
+    } while (!less(k, N) || is_zero(k));
+    return k;
+}
+
+template <class F>
+static double time_per_call(int rounds, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main() {
+    std::mt19937_64 gen(2024);
+    APoint p = to_affine(point_mul_base(random_scalar(gen)));
+
+    // 固定窗口与逐比特倍点-加比较, 包括边界标量
+    U256 one{{1, 0, 0, 0}}, n1, all;
+    sub(n1, N, one);
+    for (auto& w : all.w) w = ~0ull;
+    U256 edge[] = {U256{}, one, n1, N, all};
+    int failures = 0;
+    for (auto& k : edge) {
+        if (!point_equal(to_affine(point_mul(k, p)), to_affine(point_mul_binary(fn_reduce(k), p)))) ++failures;
+    }
+    for (int i = 0; i < 300; ++i) {
+        U256 k = random_scalar(gen);
+        if (!point_equal(to_affine(point_mul(k, p)), to_affine(point_mul_binary(k, p)))) ++failures;
+    }
+    printf("固定窗口kP: %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // sG + tP与分别计算再相加比较; 包括t·P = -s·G(结果为无穷远点)的情况
+    failures = 0;
+    WnafTable cached = make_wnaf_table(p);
+    for (int i = 0; i < 300; ++i) {
+        U256 s = random_scalar(gen), t = random_scalar(gen);
+        JPoint expect{};
+        point_add(expect, point_mul_base(s), point_mul(t, p));
+        APoint e = to_affine(expect);
+        if (!point_equal(to_affine(point_mul_sum(s, t, p)), e)) ++failures;
+        if (!point_equal(to_affine(point_mul_sum(s, t, cached)), e)) ++failures;
+    }
+    U256 s = random_scalar(gen), t;
+    fn_sub(t, U256{}, s);
+    if (!is_infinity(point_mul_sum(s, t, G_AFFINE))) ++failures;
+    if (!point_equal(to_affine(point_mul_sum(U256{}, one, p)), p)) ++failures;
+    printf("wNAF交错sG+tP: %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // 吞吐
+    const int rounds = 1000;
+    U256 k = random_scalar(gen);
+    JPoint sink = INFINITY_POINT;
+    double bin = time_per_call(rounds, [&] { sink = point_mul_binary(k, p); k.w[0] ^= sink.X.w[0] & 1; });
+    double win = time_per_call(rounds, [&] { sink = point_mul(k, p); k.w[0] ^= sink.X.w[0] & 1; });
+    printf("kP 倍点-加(变时):     %7.1f us\n", bin * 1e6);
+    printf("kP 固定窗口(常数时间): %7.1f us\n", win * 1e6);
+
+    U256 u = random_scalar(gen);
+    double sep = time_per_call(rounds, [&] {
+        point_add(sink, point_mul_base(k), point_mul_binary(u, p));
+        k.w[0] ^= sink.X.w[0] & 1;
+    });
+    double inter = time_per_call(rounds, [&] { sink = point_mul_sum(k, u, p); k.w[0] ^= sink.X.w[0] & 1; });
+    double cach = time_per_call(rounds, [&] { sink = point_mul_sum(k, u, cached); k.w[0] ^= sink.X.w[0] & 1; });
+    printf("sG+tP 分别计算:       %7.1f us\n", sep * 1e6);
+    printf("sG+tP wNAF交错:       %7.1f us  (%.1fx)\n", inter * 1e6, sep / inter);
+    printf("sG+tP 缓存公钥表:     %7.1f us  (%.1fx)\n", cach * 1e6, sep / cach);
+    return 0;
+}
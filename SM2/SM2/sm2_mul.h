@@ -0,0 +1,188 @@
+#pragma once
+
+// 任意点的标量乘法.
+//
+// point_mul(k, P): 秘密标量(解密、密钥交换), 常数时间的4比特固定窗口.
+//   预计算0P..15P(Jacobian坐标, 不求逆), 每个窗口4次倍点 + 1次加法, 共256次倍点 + 64次加法.
+//   查表扫描全部16项用掩码选出, 每个窗口都做加法(窗口为0时加的是无穷远点, 由掩码处理),
+//   没有与标量比特相关的分支和访存.
+//
+// point_mul_sum(s, t, P) = sG + tP: 验签用, 两个标量都是公开的, 可以变时.
+//   两个标量各自转成宽度w的wNAF(非零位都是奇数且相隔至少w位), 共用一串倍点交错相加:
+//   256次倍点 + 约256/(w_G+1) + 256/(w_P+1)次加法, 比分别计算再相加省掉一整串倍点.
+//   G的奇数倍表(w = 7, 32个仿射点)第一次使用时生成; P的表每次现算(w = 5, Jacobian坐标).
+//   经常验证的公钥可以先用make_wnaf_table做成仿射表缓存起来. 缓存表里同时存P和2^128·P的奇数倍,
+//   G也一样, 两个标量各拆成高低128位, 四路交错只需128次倍点.
+
+#include <cstdint>
+#include <cstddef>
+#include "sm2_point.h"
+
+namespace sm2 {
+
+// ---------------------------------------------------------------- 常数时间固定窗口
+
+constexpr int FIXED_WINDOW = 4;
+
+// 常数时间查表: table的n项全部读一遍, 选出下标为idx的一项
+inline void point_lookup(JPoint& r, const JPoint* table, unsigned n, unsigned idx) {
+    JPoint acc{};
+    for (unsigned i = 0; i < n; ++i) {
+        uint64_t d = i ^ idx;
+        uint64_t mask = ((d | (0 - d)) >> 63) - 1;
+        for (int w = 0; w < 4; ++w) {
+            acc.X.w[w] |= table[i].X.w[w] & mask;
+            acc.Y.w[w] |= table[i].Y.w[w] & mask;
+            acc.Z.w[w] |= table[i].Z.w[w] & mask;
+        }
+    }
+    r = acc;
+}
+
+// k·P, 常数时间. k先约简到[0, n), 这样累加值与表项不会相等或互为相反数(除非同为无穷远点),
+// 加法里转去倍点的分支不会走到
+inline JPoint point_mul(const U256& k, const APoint& p) {
+    U256 e = fn_reduce(k);
+    JPoint table[1 << FIXED_WINDOW];
+    table[0] = INFINITY_POINT;
+    table[1] = to_jacobian(p);
+    for (int i = 2; i < (1 << FIXED_WINDOW); ++i) {
+        if (i % 2 == 0) point_double(table[i], table[i / 2]);
+        else point_add_mixed(table[i], table[i - 1], p);
+    }
+
+    JPoint r = INFINITY_POINT, q{};
+    for (int i = 256 / FIXED_WINDOW - 1; i >= 0; --i) {
+        for (int j = 0; j < FIXED_WINDOW; ++j) point_double(r, r);
+        unsigned idx = (unsigned)(e.w[i / 16] >> (4 * (i % 16))) & 0xF;
+        point_lookup(q, table, 1 << FIXED_WINDOW, idx);
+        point_add(r, r, q);
+    }
+    return r;
+}
+
+// ---------------------------------------------------------------- wNAF交错双标量乘法
+
+constexpr int WNAF_G = 7;
+constexpr int WNAF_P = 5;
+constexpr int WNAF_MAX = 7;
+
+// 宽度w的wNAF, 低位在前; out至少257项, 返回长度. k须小于n(加上2^(w-1)不会溢出256位)
+inline int wnaf(int8_t* out, const U256& k, int w) {
+    U256 e = k;
+    int len = 0;
+    while (!is_zero(e)) {
+        int d = 0;
+        if (e.w[0] & 1) {
+            d = (int)(e.w[0] & ((1u << w) - 1));
+            if (d >= (1 << (w - 1))) d -= 1 << w;
+            U256 dd{{(uint64_t)(d > 0 ? d : -d), 0, 0, 0}};
+            if (d > 0) sub(e, e, dd);
+            else add(e, e, dd);
+        }
+        out[len++] = (int8_t)d;
+        for (int i = 0; i < 3; ++i) e.w[i] = (e.w[i] >> 1) | (e.w[i + 1] << 63);
+        e.w[3] >>= 1;
+    }
+    return len;
+}
+
+// 奇数倍表: odd[i] = (2i + 1)·P, oddHi[i] = (2i + 1)·2^128·P, i < 2^(w-2)
+struct WnafTable {
+    int w;
+    APoint odd[1 << (WNAF_MAX - 2)];
+    APoint oddHi[1 << (WNAF_MAX - 2)];
+};
+
+inline void odd_multiples(JPoint* out, const JPoint& p, int w) {
+    JPoint p2{};
+    out[0] = p;
+    point_double(p2, p);
+    for (int i = 1; i < (1 << (w - 2)); ++i) point_add(out[i], out[i - 1], p2);
+}
+
+// 公钥的仿射奇数倍表, 两组一起批量转换, 只求一次逆; 适合缓存起来反复验签
+inline WnafTable make_wnaf_table(const APoint& p, int w = WNAF_MAX) {
+    const int n = 1 << (w - 2);
+    WnafTable t{};
+    t.w = w;
+    JPoint hi = to_jacobian(p);
+    for (int i = 0; i < 128; ++i) point_double(hi, hi);
+    JPoint jac[2 << (WNAF_MAX - 2)];
+    APoint affine[2 << (WNAF_MAX - 2)];
+    U256 scratch[2 << (WNAF_MAX - 2)];
+    odd_multiples(jac, to_jacobian(p), w);
+    odd_multiples(jac + n, hi, w);
+    batch_to_affine(affine, jac, 2 * n, scratch);
+    for (int i = 0; i < n; ++i) {
+        t.odd[i] = affine[i];
+        t.oddHi[i] = affine[n + i];
+    }
+    return t;
+}
+
+inline const WnafTable& g_wnaf_table() {
+    static const WnafTable table = make_wnaf_table(G_AFFINE, WNAF_G);
+    return table;
+}
+
+// 加上±(|d|)·P, d为奇数
+inline void add_digit(JPoint& r, const APoint* odd, int d) {
+    APoint q = odd[(d > 0 ? d : -d) / 2];
+    if (d < 0) point_neg(q, q);
+    point_add_mixed(r, r, q);
+}
+
+inline void add_digit(JPoint& r, const JPoint* odd, int d) {
+    JPoint q = odd[(d > 0 ? d : -d) / 2];
+    if (d < 0) point_neg(q, q);
+    point_add(r, r, q);
+}
+
+template <class T>
+inline JPoint mul_sum_interleaved(const U256& s, const U256& t, const T* pOdd, int pw) {
+    int8_t ns[257], nt[257];
+    int ls = wnaf(ns, fn_reduce(s), WNAF_G);
+    int lt = wnaf(nt, fn_reduce(t), pw);
+    const APoint* gOdd = g_wnaf_table().odd;
+    JPoint r = INFINITY_POINT;
+    for (int i = (ls > lt ? ls : lt) - 1; i >= 0; --i) {
+        point_double(r, r);
+        if (i < ls && ns[i]) add_digit(r, gOdd, ns[i]);
+        if (i < lt && nt[i]) add_digit(r, pOdd, nt[i]);
+    }
+    return r;
+}
+
+// s·G + t·P, 变时, 只用于公开标量
+inline JPoint point_mul_sum(const U256& s, const U256& t, const APoint& p) {
+    JPoint odd[1 << (WNAF_P - 2)];
+    odd_multiples(odd, to_jacobian(p), WNAF_P);
+    return mul_sum_interleaved(s, t, odd, WNAF_P);
+}
+
+// 同上, P的奇数倍表已经缓存: s = s1·2^128 + s0, t = t1·2^128 + t0,
+// sG + tP = s0·G + s1·(2^128 G) + t0·P + t1·(2^128 P), 四路wNAF共用128次倍点
+inline JPoint point_mul_sum(const U256& s, const U256& t, const WnafTable& pTable) {
+    U256 sr = fn_reduce(s), tr = fn_reduce(t);
+    U256 part[4] = {{{sr.w[0], sr.w[1], 0, 0}}, {{sr.w[2], sr.w[3], 0, 0}},
+                    {{tr.w[0], tr.w[1], 0, 0}}, {{tr.w[2], tr.w[3], 0, 0}}};
+    const WnafTable& g = g_wnaf_table();
+    const APoint* odd[4] = {g.odd, g.oddHi, pTable.odd, pTable.oddHi};
+    int8_t naf[4][257];
+    int len[4], maxLen = 0;
+    for (int j = 0; j < 4; ++j) {
+        len[j] = wnaf(naf[j], part[j], j < 2 ? g.w : pTable.w);
+        if (len[j] > maxLen) maxLen = len[j];
+    }
+    JPoint r = INFINITY_POINT;
+    for (int i = maxLen - 1; i >= 0; --i) {
+        point_double(r, r);
+        for (int j = 0; j < 4; ++j) {
+            if (i < len[j] && naf[j][i]) add_digit(r, odd[j], naf[j][i]);
+        }
+    }
+    return r;
+}
+
+} // namespace sm2
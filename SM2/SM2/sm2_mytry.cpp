@@ -3,71 +3,54 @@
 #include <cstring>
 #include <random>
 
-// ʾԲ߲SM2ƼΪ
-struct ECPoint {
-    uint64_t x;
-    uint64_t y;
-};
+#include "sm2_comb.h"
+#include "sm2_mul.h"
+
+// ߲256λJacobianĵsm2_field.h / sm2_point.h.
+// 㱣ΪMontgomeryʽķ, (0, 0)ΪԶ
+typedef sm2::APoint ECPoint;
 
 struct SM2Key {
-    uint64_t private_key;
+    sm2::U256 private_key;
     ECPoint public_key;
 };
 
-// Բ߲򻯰棩
-const uint64_t P = 0xFFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF00000000FFFFFFFFFFFFFFFF; // P
-const uint64_t A = 0xFFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF00000000FFFFFFFFFFFFFFFC; // A
-const uint64_t B = 0x28E9FA9E9D9F5E344D5AEF6B7FC7C297FDFC7E7E7E7E7E7E7E7E7E7E7E7E7E7E; // B
-const ECPoint G = {0x32C4AE2C1F1981195F9904466A39C9948FE30BBFF2660BE1715A4589334C74C7, 
-                   0xBC3736A2F4F6779C59BDCEE36B692153D0A9877CC62A474002DF32E52139F0A0}; // G
-const uint64_t N = 0xFFFFFFFEFFFFFFFFFFFFFFFFFFFFFFFF7203DF6B21C6052B53BBF40939D54123; // N
+const ECPoint G = sm2::G_AFFINE; // G
 
-// Բ߼ӷ򻯰棩
+// Բ߼ӷ: תJacobian, ֻһ
 ECPoint ec_add(const ECPoint &p1, const ECPoint &p2) {
-    if (p1.x == 0 && p1.y == 0) return p2; // P1Զ
-    if (p2.x == 0 && p2.y == 0) return p1; // P2Զ
-
-    uint64_t lambda;
-    if (p1.x == p2.x && p1.y == p2.y) {
-        // б  = (3 * x1^2 + a) / (2 * y1) mod p
-        lambda = (3 * p1.x * p1.x + A) / (2 * p1.y);
-    } else {
-        // б  = (y2 - y1) / (x2 - x1) mod p
-        lambda = (p2.y - p1.y) / (p2.x - p1.x);
-    }
-
-    uint64_t x3 = (lambda * lambda - p1.x - p2.x) % P;
-    uint64_t y3 = (lambda * (p1.x - x3) - p1.y) % P;
+    sm2::JPoint r = sm2::to_jacobian(p1);
+    sm2::point_add_mixed(r, r, p2);
+    return sm2::to_affine(r);
+}
 
-    return {x3, y3};
+// Բ߱˷: ʱĹ̶, ȫJacobian
+ECPoint ec_mul(const sm2::U256 &k, const ECPoint &p) {
+    return sm2::to_affine(sm2::point_mul(k, p));
 }
 
-// Բ߱˷򻯰棩
-ECPoint ec_mul(uint64_t k, const ECPoint &p) {
-    ECPoint result = {0, 0}; // Զ
-    ECPoint temp = p;
-
-    while (k > 0) {
-        if (k & 1) {
-            result = ec_add(result, temp);
-        }
-        temp = ec_add(temp, temp);
-        k >>= 1;
-    }
+// k * G: Ԥα
+ECPoint ec_mul_base(const sm2::U256 &k) {
+    return sm2::to_affine(sm2::point_mul_base(k));
+}
 
-    return result;
+// [1, N-1]ڵ: ÿֱֶȡstd::random_device(ϵͳԴ), Χȡ
+static sm2::U256 random_scalar() {
+    std::random_device rd;
+    sm2::U256 k;
+    do {
+        for (auto &w : k.w) w = ((uint64_t)rd() << 32) | rd();
+    } while (!sm2::less(k, sm2::N) || sm2::is_zero(k));
+    return k;
 }
 
 // Կ
 bool sm2_key_generate(SM2Key &key) {
     // ˽Կ
-    std::random_device rd;
-    std::mt19937_64 gen(rd());
-    std::uniform_int_distribution<uint64_t> dis(1, N - 1);
-    key.private_key = dis(gen);
+    key.private_key = random_scalar();
 
     // ɹԿ˽Կ * 㣩
-    key.public_key = ec_mul(key.private_key, G);
+    key.public_key = ec_mul_base(key.private_key);
     return true;
 }
 
@@ -78,48 +61,50 @@ bool sm2_encrypt(const SM2Key &key, const uint8_t *plaintext, size_t plaintext_l
     if (plaintext_len == 0) return false;
 
     // k
-    std::random_device rd;
-    std::mt19937_64 gen(rd());
-    std::uniform_int_distribution<uint64_t> dis(1, N - 1);
-    uint64_t k = dis(gen);
+    sm2::U256 k = random_scalar();
 
     // ԲߵC1 = k * G
-    ECPoint C1 = ec_mul(k, G);
+    ECPoint C1 = ec_mul_base(k);
 
     // 㹲Կ k * PublicKey
     ECPoint shared_key = ec_mul(k, key.public_key);
 
     // 򻯣ԿxΪԿ
-    uint64_t encryption_key = shared_key.x;
+    uint8_t encryption_key[32];
+    sm2::to_bytes(encryption_key, sm2::fp_from_mont(shared_key.x));
 
-    // 
+    //  = C1(x || y, 64ֽ) || 
+    sm2::point_to_bytes(ciphertext, C1);
     for (size_t i = 0; i < plaintext_len; ++i) {
-        ciphertext[i] = plaintext[i] ^ (encryption_key & 0xFF);
-        encryption_key >>= 8;
+        ciphertext[64 + i] = plaintext[i] ^ encryption_key[i % 32];
     }
 
-    ciphertext_len = plaintext_len;
+    ciphertext_len = 64 + plaintext_len;
     return true;
 }
 
 // 
 bool sm2_decrypt(const SM2Key &key, const uint8_t *ciphertext, size_t ciphertext_len,
                  uint8_t *plaintext, size_t &plaintext_len) {
-    if (ciphertext_len == 0) return false;
+    if (ciphertext_len <= 64) return false;
+
+    // ͷȡC1, ϵĵֱӾܾ
+    ECPoint C1;
+    if (!sm2::point_from_bytes(C1, ciphertext)) return false;
 
     // 㹲Կ PrivateKey * C1
-    ECPoint shared_key = ec_mul(key.private_key, {1, 2}); // C1֪
+    ECPoint shared_key = ec_mul(key.private_key, C1);
 
     // 򻯣ԿxΪԿ
-    uint64_t decryption_key = shared_key.x;
+    uint8_t decryption_key[32];
+    sm2::to_bytes(decryption_key, sm2::fp_from_mont(shared_key.x));
 
     // 
-    for (size_t i = 0; i < ciphertext_len; ++i) {
-        plaintext[i] = ciphertext[i] ^ (decryption_key & 0xFF);
-        decryption_key >>= 8;
+    plaintext_len = ciphertext_len - 64;
+    for (size_t i = 0; i < plaintext_len; ++i) {
+        plaintext[i] = ciphertext[64 + i] ^ decryption_key[i % 32];
     }
 
-    plaintext_len = ciphertext_len;
     return true;
 }
 
@@ -146,8 +131,11 @@ int main() {
     }
 
     // ӡ˽Կ͹Կ
-    std::cout << "˽Կ: " << key.private_key << std::endl;
-    std::cout << "Կ: (" << key.public_key.x << ", " << key.public_key.y << ")" << std::endl;
+    std::vector<uint8_t> priv(32), pub(64);
+    sm2::to_bytes(priv.data(), key.private_key);
+    sm2::point_to_bytes(pub.data(), key.public_key);
+    printHex("˽Կ", priv);
+    printHex("Կ", pub);
 
     // 
     if (!sm2_encrypt(key, plaintext, sizeof(plaintext) - 1, ciphertext, ciphertext_len)) {
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cstdio>
+#include <random>
+#include <chrono>
+#include <vector>
+#include "sm2_point.h"
+
+using namespace sm2;
+
+// 仿射坐标的加法, 每次一次求逆, 用于对照
+static APoint affine_add(const APoint& p, const APoint& q) {
+    if (is_infinity(p)) return q;
+    if (is_infinity(q)) return p;
+    U256 lambda, num, den, t;
+    if (equal(p.x, q.x)) {
+        U256 sum;
+        fp_add(sum, p.y, q.y);
+        if (is_zero(sum)) return APoint{};
+        // λ = (3x^2 + a) / 2y
+        fp_sqr(num, p.x);
+        fp_add(t, num, num);
+        fp_add(num, num, t);
+        fp_add(num, num, A_MONT);
+        fp_add(den, p.y, p.y);
+    } else {
+        // λ = (y2 - y1) / (x2 - x1)
+        fp_sub(num, q.y, p.y);
+        fp_sub(den, q.x, p.x);
+    }
+    fp_inv(den, den);
+    fp_mul(lambda, num, den);
+    APoint r;
+    fp_sqr(r.x, lambda);
+    fp_sub(r.x, r.x, p.x);
+    fp_sub(r.x, r.x, q.x);
+    fp_sub(t, p.x, r.x);
+    fp_mul(t, lambda, t);
+    fp_sub(r.y, t, p.y);
+    return r;
+}
+
+static APoint affine_mul(const U256& k, const APoint& p) {
+    APoint r{};
+    for (int i = 255; i >= 0; --i) {
+        r = affine_add(r, r);
+        if ((k.w[i / 64] >> (i % 64)) & 1) r = affine_add(r, p);
+    }
+    return r;
+}
+
+static U256 random_scalar(std::mt19937_64& gen) {
+    U256 k;
+    do {
+        for (auto& w : k.w) w = gen();
+    } while (!less(k, N) || is_zero(k));
+    return k;
+}
+
+int main() {
+    std::mt19937_64 gen(2024);
+
+    // n·G为无穷远点, (n-1)·G = -G
+    U256 n1, one{{1, 0, 0, 0}};
+    sub(n1, N, one);
+    APoint negG;
+    point_neg(negG, G_AFFINE);
+    printf("n·G = O: %s\n", is_infinity(point_mul_binary(N, G_AFFINE)) ? "是" : "否!");
+    printf("(n-1)·G = -G: %s\n", point_equal(to_affine(point_mul_binary(n1, G_AFFINE)), negG) ? "是" : "否!");
+
+    // 与仿射坐标的逐次求逆实现比较, 并检查加法律
+    int failures = 0;
+    for (int i = 0; i < 50; ++i) {
+        U256 k1 = random_scalar(gen), k2 = random_scalar(gen), k3;
+        APoint a = to_affine(point_mul_binary(k1, G_AFFINE));
+        if (!on_curve(a) || !point_equal(a, affine_mul(k1, G_AFFINE))) ++failures;
+        // (k1 + k2)G = k1·G + k2·G, 分别用混合加法和Jacobian加法
+        JPoint j1 = point_mul_binary(k1, G_AFFINE), j2 = point_mul_binary(k2, G_AFFINE), s, m;
+        fn_add(k3, k1, k2);
+        point_add(s, j1, j2);
+        point_add_mixed(m, j1, to_affine(j2));
+        APoint expect = to_affine(point_mul_binary(k3, G_AFFINE));
+        if (!point_equal(to_affine(s), expect) || !point_equal(to_affine(m), expect)) ++failures;
+        // 相等的输入转去倍点, 相反的输入得到无穷远点
+        JPoint d, d2, o;
+        point_add(d, j1, j1);
+        point_double(d2, j1);
+        if (!point_equal(to_affine(d), to_affine(d2))) ++failures;
+        APoint na;
+        point_neg(na, a);
+        point_add_mixed(o, j1, na);
+        if (!is_infinity(o)) ++failures;
+    }
+    printf("与仿射坐标实现比较: %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // 批量转换只求一次逆
+    std::vector<JPoint> js(64);
+    std::vector<APoint> as(64);
+    std::vector<U256> scratch(64);
+    JPoint acc = INFINITY_POINT;
+    for (auto& j : js) {
+        point_add_mixed(acc, acc, G_AFFINE);
+        j = acc;
+    }
+    js[10] = INFINITY_POINT;
+    batch_to_affine(as.data(), js.data(), js.size(), scratch.data());
+    failures = 0;
+    for (size_t i = 0; i < js.size(); ++i) {
+        if (!point_equal(as[i], to_affine(js[i]))) ++failures;
+    }
+    printf("批量转仿射坐标: %s\n", failures == 0 ? "一致" : "不一致!");
+
+    // 吞吐: 每次加法求逆 vs Jacobian坐标只在最后求一次逆
+    const int rounds = 20;
+    U256 k = random_scalar(gen);
+    auto start = std::chrono::steady_clock::now();
+    APoint r1{};
+    for (int i = 0; i < rounds; ++i) r1 = affine_mul(k, G_AFFINE);
+    double affineSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds;
+    start = std::chrono::steady_clock::now();
+    APoint r2{};
+    for (int i = 0; i < rounds * 20; ++i) r2 = to_affine(point_mul_binary(k, G_AFFINE));
+    double jacSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / (rounds * 20);
+    printf("kP 仿射坐标:   %8.1f us\n", affineSec * 1e6);
+    printf("kP Jacobian:   %8.1f us  (%.1fx)  %s\n", jacSec * 1e6, affineSec / jacSec,
+           point_equal(r1, r2) ? "结果一致" : "结果不一致!");
+    return 0;
+}
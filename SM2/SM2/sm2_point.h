@@ -0,0 +1,290 @@
+#pragma once
+
+// SM2曲线上的点运算, 坐标都是sm2_field.h里的Montgomery形式.
+//
+// 仿射坐标下每次加法都要一次模逆(约是模乘的600倍), 这里改用Jacobian坐标:
+//   (X, Y, Z) 表示仿射点 (X/Z^2, Y/Z^3), Z = 0 为无穷远点.
+// 加法和倍点都不需要求逆, 只在最后转回仿射坐标时求一次逆; 多个点一起转换时用
+// Montgomery技巧, n个点也只求一次逆.
+//   倍点(a = -3专用, dbl-2001-b):     3M + 5S
+//   Jacobian + 仿射的混合加法(madd): 7M + 4S, 预计算表里的点都存仿射坐标
+//   Jacobian + Jacobian(add-2007-bl): 11M + 5S
+// 仿射点(0, 0)表示无穷远点(b != 0, 它不在曲线上).
+//
+// 加法里的无穷远点用掩码选择处理, 不分支; 只有两个输入恰好相等时才转去倍点,
+// 秘密标量的固定窗口/梳形算法里这种情况不会出现.
+
+#include <cstdint>
+#include <cstddef>
+#include "sm2_field.h"
+
+namespace sm2 {
+
+struct JPoint {
+    U256 X, Y, Z;
+};
+
+struct APoint {
+    U256 x, y;
+};
+
+inline constexpr APoint G_AFFINE = {GX_MONT, GY_MONT};
+inline constexpr JPoint INFINITY_POINT = {FP_ONE, FP_ONE, U256{}};
+
+// a为0时返回全1, 否则返回0
+constexpr uint64_t zero_mask(const U256& a) {
+    uint64_t x = a.w[0] | a.w[1] | a.w[2] | a.w[3];
+    return ((x | (0 - x)) >> 63) - 1;
+}
+
+constexpr void point_select(JPoint& r, uint64_t mask, const JPoint& a, const JPoint& b) {
+    select(r.X, mask, a.X, b.X);
+    select(r.Y, mask, a.Y, b.Y);
+    select(r.Z, mask, a.Z, b.Z);
+}
+
+constexpr bool is_infinity(const JPoint& p) {
+    return is_zero(p.Z);
+}
+
+constexpr bool is_infinity(const APoint& p) {
+    return is_zero(p.x) && is_zero(p.y);
+}
+
+constexpr JPoint to_jacobian(const APoint& p) {
+    JPoint r{p.x, p.y, FP_ONE};
+    point_select(r, zero_mask(p.x) & zero_mask(p.y), INFINITY_POINT, r);
+    return r;
+}
+
+constexpr void point_neg(JPoint& r, const JPoint& p) {
+    r.X = p.X;
+    fp_neg(r.Y, p.Y);
+    r.Z = p.Z;
+}
+
+constexpr void point_neg(APoint& r, const APoint& p) {
+    r.x = p.x;
+    fp_neg(r.y, p.y);
+}
+
+// r = 2p. a = -3时 3X^2 + aZ^4 = 3(X - Z^2)(X + Z^2); 无穷远点(Z = 0)的结果仍是Z = 0
+constexpr void point_double(JPoint& r, const JPoint& p) {
+    U256 delta{}, gamma{}, beta{}, alpha{}, t{}, u{};
+    fp_sqr(delta, p.Z);
+    fp_sqr(gamma, p.Y);
+    fp_mul(beta, p.X, gamma);
+    fp_sub(t, p.X, delta);
+    fp_add(u, p.X, delta);
+    fp_mul(alpha, t, u);
+    fp_add(t, alpha, alpha);
+    fp_add(alpha, alpha, t);
+
+    // Z3 = (Y + Z)^2 - gamma - delta, 先算, 允许r与p是同一个对象
+    fp_add(t, p.Y, p.Z);
+    fp_sqr(t, t);
+    fp_sub(t, t, gamma);
+    fp_sub(r.Z, t, delta);
+
+    // X3 = alpha^2 - 8beta
+    fp_add(beta, beta, beta);
+    fp_add(beta, beta, beta);
+    fp_add(u, beta, beta);
+    fp_sqr(t, alpha);
+    fp_sub(r.X, t, u);
+
+    // Y3 = alpha(4beta - X3) - 8gamma^2
+    fp_sub(t, beta, r.X);
+    fp_mul(t, alpha, t);
+    fp_sqr(gamma, gamma);
+    fp_add(gamma, gamma, gamma);
+    fp_add(gamma, gamma, gamma);
+    fp_add(gamma, gamma, gamma);
+    fp_sub(r.Y, t, gamma);
+}
+
+// r = p + q, q为仿射点. r可以与p是同一个对象
+constexpr void point_add_mixed(JPoint& r, const JPoint& p, const APoint& q) {
+    U256 z1z1{}, u2{}, s2{}, h{}, hh{}, i{}, j{}, rr{}, v{}, t{};
+    fp_sqr(z1z1, p.Z);
+    fp_mul(u2, q.x, z1z1);
+    fp_mul(s2, q.y, p.Z);
+    fp_mul(s2, s2, z1z1);
+    fp_sub(h, u2, p.X);
+    fp_sub(rr, s2, p.Y);
+
+    uint64_t pInf = zero_mask(p.Z);
+    uint64_t qInf = zero_mask(q.x) & zero_mask(q.y);
+    if (((zero_mask(h) & zero_mask(rr)) & ~pInf & ~qInf) != 0) {
+        // p == q
+        JPoint d{};
+        point_double(d, p);
+        r = d;
+        return;
+    }
+
+    JPoint s{};
+    fp_sqr(hh, h);
+    fp_add(i, hh, hh);
+    fp_add(i, i, i);
+    fp_mul(j, h, i);
+    fp_add(rr, rr, rr);
+    fp_mul(v, p.X, i);
+
+    // X3 = r^2 - J - 2V
+    fp_sqr(t, rr);
+    fp_sub(t, t, j);
+    fp_sub(t, t, v);
+    fp_sub(s.X, t, v);
+    // Y3 = r(V - X3) - 2Y1·J
+    fp_sub(t, v, s.X);
+    fp_mul(t, rr, t);
+    fp_mul(j, p.Y, j);
+    fp_add(j, j, j);
+    fp_sub(s.Y, t, j);
+    // Z3 = (Z1 + H)^2 - Z1Z1 - HH
+    fp_add(t, p.Z, h);
+    fp_sqr(t, t);
+    fp_sub(t, t, z1z1);
+    fp_sub(s.Z, t, hh);
+
+    JPoint qj{q.x, q.y, FP_ONE};
+    point_select(s, pInf, qj, s);
+    point_select(r, qInf, p, s);
+}
+
+// r = p + q, 都是Jacobian坐标
+constexpr void point_add(JPoint& r, const JPoint& p, const JPoint& q) {
+    U256 z1z1{}, z2z2{}, u1{}, u2{}, s1{}, s2{}, h{}, i{}, j{}, rr{}, v{}, t{};
+    fp_sqr(z1z1, p.Z);
+    fp_sqr(z2z2, q.Z);
+    fp_mul(u1, p.X, z2z2);
+    fp_mul(u2, q.X, z1z1);
+    fp_mul(s1, p.Y, q.Z);
+    fp_mul(s1, s1, z2z2);
+    fp_mul(s2, q.Y, p.Z);
+    fp_mul(s2, s2, z1z1);
+    fp_sub(h, u2, u1);
+    fp_sub(rr, s2, s1);
+
+    uint64_t pInf = zero_mask(p.Z);
+    uint64_t qInf = zero_mask(q.Z);
+    if (((zero_mask(h) & zero_mask(rr)) & ~pInf & ~qInf) != 0) {
+        JPoint d{};
+        point_double(d, p);
+        r = d;
+        return;
+    }
+
+    JPoint s{};
+    fp_add(i, h, h);
+    fp_sqr(i, i);
+    fp_mul(j, h, i);
+    fp_add(rr, rr, rr);
+    fp_mul(v, u1, i);
+
+    fp_sqr(t, rr);
+    fp_sub(t, t, j);
+    fp_sub(t, t, v);
+    fp_sub(s.X, t, v);
+    fp_sub(t, v, s.X);
+    fp_mul(t, rr, t);
+    fp_mul(s1, s1, j);
+    fp_add(s1, s1, s1);
+    fp_sub(s.Y, t, s1);
+    // Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2)·H
+    fp_add(t, p.Z, q.Z);
+    fp_sqr(t, t);
+    fp_sub(t, t, z1z1);
+    fp_sub(t, t, z2z2);
+    fp_mul(s.Z, t, h);
+
+    point_select(s, pInf, q, s);
+    point_select(r, qInf, p, s);
+}
+
+// 转回仿射坐标, 一次求逆; 无穷远点得到(0, 0)
+constexpr APoint to_affine(const JPoint& p) {
+    U256 zinv{}, zinv2{};
+    fp_inv(zinv, p.Z);
+    fp_sqr(zinv2, zinv);
+    APoint r{};
+    fp_mul(r.x, p.X, zinv2);
+    fp_mul(zinv2, zinv2, zinv);
+    fp_mul(r.y, p.Y, zinv2);
+    return r;
+}
+
+// n个点一起转换, 共用一次求逆: 先算Z的前缀积, 逆一次后从后往前逐个剥离.
+// 无穷远点的Z换成1参与前缀积, 输出为(0, 0). scratch至少n个元素
+inline void batch_to_affine(APoint* out, const JPoint* in, size_t n, U256* scratch) {
+    if (n == 0) return;
+    U256 acc = FP_ONE;
+    for (size_t i = 0; i < n; ++i) {
+        U256 z{};
+        select(z, zero_mask(in[i].Z), FP_ONE, in[i].Z);
+        fp_mul(acc, acc, z);
+        scratch[i] = acc;
+    }
+    U256 inv{};
+    fp_inv(inv, acc);
+    for (size_t i = n; i-- > 0;) {
+        U256 z{}, zinv{}, zinv2{};
+        select(z, zero_mask(in[i].Z), FP_ONE, in[i].Z);
+        // inv = (Z_0 ... Z_i)^-1
+        if (i > 0) fp_mul(zinv, inv, scratch[i - 1]);
+        else zinv = inv;
+        fp_mul(inv, inv, z);
+        fp_sqr(zinv2, zinv);
+        APoint r{};
+        fp_mul(r.x, in[i].X, zinv2);
+        fp_mul(zinv2, zinv2, zinv);
+        fp_mul(r.y, in[i].Y, zinv2);
+        uint64_t inf = zero_mask(in[i].Z);
+        U256 zero{};
+        select(out[i].x, inf, zero, r.x);
+        select(out[i].y, inf, zero, r.y);
+    }
+}
+
+// y^2 = x^3 - 3x + b
+constexpr bool on_curve(const APoint& p) {
+    U256 y2{}, x3{}, t{};
+    fp_sqr(y2, p.y);
+    fp_sqr(x3, p.x);
+    fp_mul(x3, x3, p.x);
+    fp_mul(t, A_MONT, p.x);
+    fp_add(x3, x3, t);
+    fp_add(x3, x3, B_MONT);
+    return equal(y2, x3);
+}
+
+constexpr bool point_equal(const APoint& a, const APoint& b) {
+    return equal(a.x, b.x) && equal(a.y, b.y);
+}
+
+// 公钥等外部格式: x || y, 各32字节大端, 普通(非Montgomery)形式
+inline bool point_from_bytes(APoint& r, const uint8_t in[64]) {
+    U256 x = from_bytes(in), y = from_bytes(in + 32);
+    if (!less(x, P) || !less(y, P)) return false;
+    r.x = fp_to_mont(x);
+    r.y = fp_to_mont(y);
+    return on_curve(r);
+}
+
+inline void point_to_bytes(uint8_t out[64], const APoint& p) {
+    to_bytes(out, fp_from_mont(p.x));
+    to_bytes(out + 32, fp_from_mont(p.y));
+}
+
+// 从高位到低位的倍点-加, 标量k为普通整数. 按比特分支, 不是常数时间, 只用于公开标量和对照
+inline JPoint point_mul_binary(const U256& k, const APoint& p) {
+    JPoint r = INFINITY_POINT;
+    for (int i = 255; i >= 0; --i) {
+        point_double(r, r);
+        if ((k.w[i / 64] >> (i % 64)) & 1) point_add_mixed(r, r, p);
+    }
+    return r;
+}
+
+} // namespace sm2
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <chrono>
+#include <vector>
+#include "sm2_sign.h"
+
+static void fromHex(const char* hex, uint8_t* out) {
+    for (size_t i = 0; hex[2 * i]; ++i) {
+        unsigned v;
+        sscanf(hex + 2 * i, "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+}
+
+template <class F>
+static double time_per_call(int rounds, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main() {
+    // GB/T 32918.5附录中的签名示例: 默认ID, 消息"message digest"
+    uint8_t priv[32], k[32], expectPub[65], expectSig[64], pub[65], sig[64];
+    fromHex("3945208F7B2144B13F36E38AC6D39F95889393692860B51A42FB81EF4DF7C5B8", priv);
+    fromHex("59276E27D506861A16680F3AD9C02DCCEF3CC1FA3CDBE4CE6D54B80DEAC1BC21", k);
+    fromHex("0409F9DF311E5421A150DD7D161E4BC5C672179FAD1833FC076BB08FF356F35020"
+            "CCEA490CE26775A52DC6EA718CC1AA600AED05FBF35E084A6632F6072DA9AD13", expectPub);
+    fromHex("F5A03B0648D2C4630EEAC513E1BB81A15944DA3827D5B74143AC7EACEEE720B3"
+            "B1B6AA29DF212FD8763182BC0D421CA1BB9038FD1F7F42D4840B69C485BBC1AA", expectSig);
+    const uint8_t msg[] = "message digest";
+    const size_t msgLen = sizeof(msg) - 1;
+
+    SM2Signer signer(priv);
+    signer.public_key(pub);
+    signer.sign_with_k(msg, msgLen, k, sig);
+    printf("公钥: %s\n", std::memcmp(pub, expectPub, 65) == 0 ? "一致" : "不一致!");
+    printf("签名: %s\n", std::memcmp(sig, expectSig, 64) == 0 ? "一致" : "不一致!");
+
+    SM2Verifier verifier(pub, sizeof(pub));
+    printf("验签: %s\n", verifier.verify(msg, msgLen, expectSig) ? "通过" : "失败!");
+
+    // 压缩公钥解析后得到同一个Z_A
+    uint8_t compressed[33];
+    compressed[0] = 0x02 | (pub[64] & 1);
+    std::memcpy(compressed + 1, pub + 1, 32);
+    SM2Verifier fromCompressed(compressed, sizeof(compressed));
+    printf("压缩公钥: %s\n", fromCompressed.valid() && std::memcmp(fromCompressed.z(), verifier.z(), 32) == 0
+                                 ? "一致" : "不一致!");
+
+    // 随机密钥和消息: 签名能通过验签, 改动消息、签名或ID后都不能通过
+    std::mt19937_64 gen(2024);
+    int failures = 0;
+    const uint8_t otherId[] = "ALICE123@YAHOO.COM";
+    for (int i = 0; i < 100; ++i) {
+        uint8_t d[32];
+        for (auto& b : d) b = (uint8_t)gen();
+        d[0] &= 0x7F;
+        SM2Signer s(d, i % 2 ? otherId : nullptr, sizeof(otherId) - 1);
+        uint8_t p[65];
+        s.public_key(p);
+        std::vector<uint8_t> m(gen() % 300);
+        for (auto& b : m) b = (uint8_t)gen();
+        if (!s.sign(m.data(), m.size(), sig)) ++failures;
+        SM2Verifier v(p, sizeof(p), i % 2 ? otherId : nullptr, sizeof(otherId) - 1);
+        SM2Verifier wrongId(p, sizeof(p), i % 2 ? nullptr : otherId, sizeof(otherId) - 1);
+        if (!v.verify(m.data(), m.size(), sig)) ++failures;
+        if (!sm2_verify(p, sizeof(p), m.data(), m.size(), sig, i % 2 ? otherId : nullptr, sizeof(otherId) - 1)) {
+            ++failures;
+        }
+        if (wrongId.verify(m.data(), m.size(), sig)) ++failures;
+        sig[gen() % 64] ^= (uint8_t)(1 << (gen() % 8));
+        if (v.verify(m.data(), m.size(), sig)) ++failures;
+        if (!m.empty()) {
+            s.sign(m.data(), m.size(), sig);
+            m[gen() % m.size()] ^= 1;
+            if (v.verify(m.data(), m.size(), sig)) ++failures;
+        }
+    }
+    printf("随机签名/验签/篡改检测: %s\n", failures == 0 ? "全部正确" : "有错误!");
+
+    // 缓存: 同一公钥只建一次表
+    SM2VerifierCache cache(16);
+    for (int i = 0; i < 10; ++i) {
+        auto v = cache.get(pub, sizeof(pub));
+        if (!v || !v->verify(msg, msgLen, expectSig)) ++failures;
+    }
+    uint8_t bad[65];
+    std::memcpy(bad, pub, 65);
+    bad[64] ^= 1;
+    printf("验签缓存: 命中%llu次, 未命中%llu次, 无效公钥%s\n", (unsigned long long)cache.hits(),
+           (unsigned long long)cache.misses(), cache.get(bad, sizeof(bad)) ? "被接受!" : "被拒绝");
+
+    // 吞吐
+    const int rounds = 2000;
+    std::vector<uint8_t> m(256, 0x5A);
+    double signSec = time_per_call(rounds, [&] { signer.sign(m.data(), m.size(), sig); });
+    double buildSec = time_per_call(rounds / 4, [&] {
+        SM2Verifier v(pub, sizeof(pub));
+        v.verify(m.data(), m.size(), sig);
+    });
+    double coldSec = time_per_call(rounds / 4, [&] { sm2_verify(pub, sizeof(pub), m.data(), m.size(), sig); });
+    double hotSec = time_per_call(rounds, [&] { verifier.verify(m.data(), m.size(), sig); });
+    printf("签名:             %7.1f us  %8.0f 次/s\n", signSec * 1e6, 1 / signSec);
+    printf("建表+验签一次:    %7.1f us  %8.0f 次/s\n", buildSec * 1e6, 1 / buildSec);
+    printf("验签(一次性):     %7.1f us  %8.0f 次/s\n", coldSec * 1e6, 1 / coldSec);
+    printf("验签(缓存公钥):   %7.1f us  %8.0f 次/s\n", hotSec * 1e6, 1 / hotSec);
+    return 0;
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+// SM2数字签名(GB/T 32918.2), 杂凑用SM3.
+//
+//   Z_A = SM3(ENTL || ID || a || b || xG || yG || xA || yA)
+//   e   = SM3(Z_A || M)
+//   签名: (x1, y1) = kG, r = (e + x1) mod n, s = (1 + d)^-1 · (k - r·d) mod n
+//   验签: t = (r + s) mod n, (x1, y1) = sG + tP, 检查 (e + x1) mod n == r
+//
+// 每个密钥只算一次的东西都缓存在SM2Signer/SM2Verifier里:
+//   - Z_A, 以及已经吸收了Z_A的SM3上下文, 每条消息复制一份接着update;
+//   - 默认ID下ENTL||ID||a||b||xG||yG共146字节, 前两组的压缩结果全局共享, 新公钥算Z_A只需再压缩两组;
+//   - 签名方: (1 + d)^-1的Montgomery形式, kG走梳形表(sm2_comb.h);
+//   - 验签方: 公钥的wNAF仿射奇数倍表(sm2_mul.h), sG + tP只需128次倍点.
+// 验签时不把sG + tP转回仿射坐标, 而是直接比较X == x1·Z^2, 省掉一次求逆.
+// SM2VerifierCache按公钥(和ID)缓存SM2Verifier, 用法与SM4KeyCache相同.
+//
+// 用法: SM2Signer signer(priv);                 uint8_t sig[64]; signer.sign(msg, len, sig);
+//       SM2Verifier verifier(pub, pubLen);      bool ok = verifier.verify(msg, len, sig);
+//       bool ok = sm2_verify(pub, pubLen, msg, len, sig);  // 一次性验签
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "../../SM3/sm3.h"
+#include "sm2_comb.h"
+#include "sm2_mul.h"
+
+namespace sm2 {
+
+// 未指定用户ID时使用的默认值
+inline constexpr char DEFAULT_ID[] = "1234567812345678";
+
+// ENTL || ID || a || b || xG || yG 之后的SM3上下文
+inline SM3 za_prefix(const uint8_t* id, size_t idLen) {
+    SM3 h;
+    uint16_t entl = (uint16_t)(idLen * 8);
+    uint8_t buf[32] = {(uint8_t)(entl >> 8), (uint8_t)entl};
+    h.update(buf, 2);
+    h.update(id, idLen);
+    const U256 params[4] = {A_MONT, B_MONT, GX_MONT, GY_MONT};
+    for (const U256& v : params) {
+        to_bytes(buf, fp_from_mont(v));
+        h.update(buf, 32);
+    }
+    return h;
+}
+
+inline const SM3& default_za_prefix() {
+    static const SM3 prefix = za_prefix((const uint8_t*)DEFAULT_ID, sizeof(DEFAULT_ID) - 1);
+    return prefix;
+}
+
+// Z_A; id为空指针时用默认ID. ID超过8191字节(ENTL放不下)时返回false
+inline bool compute_za(uint8_t za[32], const APoint& pub, const uint8_t* id = nullptr, size_t idLen = 0) {
+    if (idLen >= 8192) return false;
+    SM3 h = id ? za_prefix(id, idLen) : default_za_prefix();
+    uint8_t xy[64];
+    point_to_bytes(xy, pub);
+    h.update(xy, 64);
+    h.finalize(za);
+    return true;
+}
+
+// p ≡ 3 (mod 4), 平方根为a^((p+1)/4); a不是平方剩余时返回false
+inline bool fp_sqrt(U256& r, const U256& a) {
+    U256 e{}, one{{1, 0, 0, 0}}, root{}, check{};
+    add(e, P, one);
+    for (int i = 0; i < 3; ++i) e.w[i] = (e.w[i] >> 2) | (e.w[i + 1] << 62);
+    e.w[3] >>= 2;
+    fp_pow(root, a, e);
+    fp_sqr(check, root);
+    if (!equal(check, a)) return false;
+    r = root;
+    return true;
+}
+
+// 公钥编码: 04 || x || y (65字节), 02/03 || x (33字节, 压缩形式, 需要开平方), 或裸的x || y (64字节)
+inline bool parse_public_key(APoint& r, const uint8_t* in, size_t len) {
+    if (len == 64) return point_from_bytes(r, in);
+    if (len == 65 && in[0] == 0x04) return point_from_bytes(r, in + 1);
+    if (len != 33 || (in[0] != 0x02 && in[0] != 0x03)) return false;
+    U256 x = from_bytes(in + 1);
+    if (!less(x, P)) return false;
+    APoint q{fp_to_mont(x), U256{}};
+    U256 rhs{}, t{};
+    fp_sqr(rhs, q.x);
+    fp_mul(rhs, rhs, q.x);
+    fp_mul(t, A_MONT, q.x);
+    fp_add(rhs, rhs, t);
+    fp_add(rhs, rhs, B_MONT);
+    if (!fp_sqrt(q.y, rhs)) return false;
+    if ((fp_from_mont(q.y).w[0] & 1) != (uint64_t)(in[0] & 1)) fp_neg(q.y, q.y);
+    r = q;
+    return true;
+}
+
+// SM3(Z_A || M)取模n. prefix为已吸收Z_A的SM3上下文
+inline U256 message_digest(const SM3& prefix, const uint8_t* msg, size_t len) {
+    SM3 h = prefix;
+    h.update(msg, len);
+    uint8_t e[32];
+    h.finalize(e);
+    return fn_reduce(from_bytes(e));
+}
+
+// Jacobian点的仿射x坐标是否等于x(普通形式)
+inline bool jacobian_x_equals(const JPoint& p, const U256& x) {
+    U256 z2{}, t{};
+    fp_sqr(z2, p.Z);
+    fp_mul(t, fp_to_mont(x), z2);
+    return equal(t, p.X);
+}
+
+// 验签主体. pub为公钥点(APoint, 奇数倍表现算)或缓存的WnafTable
+template <class PubT>
+inline bool verify_signature(const SM3& prefix, const PubT& pub, const uint8_t* msg, size_t len,
+                             const uint8_t sig[64]) {
+    U256 r = from_bytes(sig), s = from_bytes(sig + 32);
+    if (is_zero(r) || is_zero(s) || !less(r, N) || !less(s, N)) return false;
+    U256 t{};
+    fn_add(t, r, s);
+    if (is_zero(t)) return false;
+
+    U256 e = message_digest(prefix, msg, len);
+    JPoint q = point_mul_sum(s, t, pub);
+    if (is_infinity(q)) return false;
+
+    // (e + x1) mod n == r  <=>  x1 == (r - e) mod n 或 (r - e) mod n + n(仍小于p时)
+    U256 v{}, v2{};
+    fn_sub(v, r, e);
+    if (jacobian_x_equals(q, v)) return true;
+    return add(v2, v, N) == 0 && less(v2, P) && jacobian_x_equals(q, v2);
+}
+
+} // namespace sm2
+
+// 公钥对应的验签上下文: 构造时解析公钥、算Z_A和奇数倍表, 之后只读, 可多线程共用
+class SM2Verifier {
+public:
+    SM2Verifier(const uint8_t* pub, size_t pubLen, const uint8_t* id = nullptr, size_t idLen = 0) : ok(false) {
+        if (!sm2::parse_public_key(point, pub, pubLen) || !sm2::compute_za(za, point, id, idLen)) return;
+        prefix.update(za, 32);
+        table = sm2::make_wnaf_table(point);
+        ok = true;
+    }
+
+    // 公钥格式错误、不在曲线上或ID过长时为false, 此时verify总是失败
+    bool valid() const { return ok; }
+
+    const uint8_t* z() const { return za; }
+
+    // sig = r || s, 各32字节大端
+    bool verify(const uint8_t* msg, size_t len, const uint8_t sig[64]) const {
+        return ok && sm2::verify_signature(prefix, table, msg, len, sig);
+    }
+
+private:
+    bool ok;
+    sm2::APoint point;
+    uint8_t za[32];
+    SM3 prefix;
+    sm2::WnafTable table;
+};
+
+// 一次性验签: 不建公钥的奇数倍表, 适合只验一两次的公钥; 反复验签用SM2Verifier/SM2VerifierCache
+inline bool sm2_verify(const uint8_t* pub, size_t pubLen, const uint8_t* msg, size_t len, const uint8_t sig[64],
+                       const uint8_t* id = nullptr, size_t idLen = 0) {
+    sm2::APoint point;
+    uint8_t za[32];
+    if (!sm2::parse_public_key(point, pub, pubLen) || !sm2::compute_za(za, point, id, idLen)) return false;
+    SM3 prefix;
+    prefix.update(za, 32);
+    return sm2::verify_signature(prefix, point, msg, len, sig);
+}
+
+// 私钥对应的签名上下文; 析构时清零私钥相关的数据
+class SM2Signer {
+public:
+    SM2Signer(const uint8_t priv[32], const uint8_t* id = nullptr, size_t idLen = 0) : ok(false) {
+        using namespace sm2;
+        U256 d = from_bytes(priv), one{{1, 0, 0, 0}}, n1{}, t{};
+        sub(n1, N, one);
+        // d须在[1, n-2]内
+        if (is_zero(d) || !less(d, n1)) return;
+        point = to_affine(point_mul_base(d));
+        if (!compute_za(za, point, id, idLen)) return;
+        prefix.update(za, 32);
+        dMont = fn_to_mont(d);
+        fn_add(t, dMont, FN_ONE);
+        fn_inv(inv1d, t);
+        volatile uint64_t* p = d.w;
+        for (int i = 0; i < 4; ++i) p[i] = 0;
+        ok = true;
+    }
+
+    ~SM2Signer() {
+        volatile uint64_t* p = dMont.w;
+        for (int i = 0; i < 4; ++i) p[i] = 0;
+        p = inv1d.w;
+        for (int i = 0; i < 4; ++i) p[i] = 0;
+    }
+
+    SM2Signer(const SM2Signer&) = delete;
+    SM2Signer& operator=(const SM2Signer&) = delete;
+
+    bool valid() const { return ok; }
+
+    const uint8_t* z() const { return za; }
+
+    // 公钥, 04 || x || y
+    void public_key(uint8_t out[65]) const {
+        out[0] = 0x04;
+        sm2::point_to_bytes(out + 1, point);
+    }
+
+    // 随机数k取自std::random_device
+    bool sign(const uint8_t* msg, size_t len, uint8_t sig[64]) const {
+        std::random_device rd;
+        for (int attempt = 0; attempt < 16; ++attempt) {
+            uint8_t k[32];
+            for (int i = 0; i < 32; i += 4) {
+                uint32_t v = rd();
+                std::memcpy(k + i, &v, 4);
+            }
+            bool done = sign_with_k(msg, len, k, sig);
+            volatile uint8_t* p = k;
+            for (int i = 0; i < 32; ++i) p[i] = 0;
+            if (done) return true;
+        }
+        return false;
+    }
+
+    // 指定k(大端32字节), 用于测试向量; k不在[1, n-1]内或遇到r = 0、r + k = n、s = 0时返回false
+    bool sign_with_k(const uint8_t* msg, size_t len, const uint8_t kBytes[32], uint8_t sig[64]) const {
+        using namespace sm2;
+        if (!ok) return false;
+        U256 k = from_bytes(kBytes);
+        if (is_zero(k) || !less(k, N)) return false;
+
+        U256 e = message_digest(prefix, msg, len);
+        APoint kg = to_affine(point_mul_base(k));
+        U256 r{}, rk{}, s{}, t{};
+        fn_add(r, e, fn_reduce(fp_from_mont(kg.x)));
+        fn_add(rk, r, k);
+        if (is_zero(r) || is_zero(rk)) return false;
+
+        // s = (1 + d)^-1 · (k - r·d), 在Montgomery形式下计算
+        U256 rm = fn_to_mont(r);
+        fn_mul(t, rm, dMont);
+        fn_sub(t, fn_to_mont(k), t);
+        fn_mul(s, inv1d, t);
+        s = fn_from_mont(s);
+        if (is_zero(s)) return false;
+        to_bytes(sig, r);
+        to_bytes(sig + 32, s);
+        return true;
+    }
+
+private:
+    bool ok;
+    sm2::APoint point;
+    uint8_t za[32];
+    SM3 prefix;
+    sm2::U256 dMont;  // d的Montgomery形式
+    sm2::U256 inv1d;  // (1 + d)^-1的Montgomery形式
+};
+
+// 按公钥(及ID)缓存SM2Verifier, 容量固定, LRU淘汰; 线程安全, 未命中时在锁外建表
+class SM2VerifierCache {
+public:
+    typedef std::shared_ptr<const SM2Verifier> VerifierPtr;
+
+    explicit SM2VerifierCache(size_t capacity) : cap(capacity ? capacity : 1), hitCount(0), missCount(0) {}
+
+    SM2VerifierCache(const SM2VerifierCache&) = delete;
+    SM2VerifierCache& operator=(const SM2VerifierCache&) = delete;
+
+    // 命中直接返回; 未命中时解析公钥、建表后存入. 公钥无效时返回空指针且不缓存
+    VerifierPtr get(const uint8_t* pub, size_t pubLen, const uint8_t* id = nullptr, size_t idLen = 0) {
+        std::string key = make_key(pub, pubLen, id, idLen);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it != index.end()) {
+                ++hitCount;
+                lru.splice(lru.begin(), lru, it->second);
+                return it->second->second;
+            }
+            ++missCount;
+        }
+
+        VerifierPtr built = std::make_shared<const SM2Verifier>(pub, pubLen, id, idLen);
+        if (!built->valid()) return VerifierPtr();
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+        }
+        lru.emplace_front(key, built);
+        index[key] = lru.begin();
+        if (lru.size() > cap) {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+        return built;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        lru.clear();
+        index.clear();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lru.size();
+    }
+
+    uint64_t hits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hitCount;
+    }
+
+    uint64_t misses() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return missCount;
+    }
+
+private:
+    typedef std::list<std::pair<std::string, VerifierPtr>> List;
+
+    const size_t cap;
+    mutable std::mutex mutex;
+    List lru;  // 表头为最近使用
+    std::unordered_map<std::string, List::iterator> index;
+    uint64_t hitCount, missCount;
+
+    // 公钥长度(1) || 公钥编码 || 是否指定ID(1) || ID, 不同的(公钥, ID)不会拼成同一个键.
+    // 同一公钥的不同编码, 以及不指定ID与显式传入默认ID, 各自占一项
+    static std::string make_key(const uint8_t* pub, size_t pubLen, const uint8_t* id, size_t idLen) {
+        std::string key(1, (char)pubLen);
+        key.append((const char*)pub, pubLen);
+        key.push_back(id ? 1 : 0);
+        if (id) key.append((const char*)id, idLen);
+        return key;
+    }
+};
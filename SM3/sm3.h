@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <utility>
+
+// 预先循环移位好的轮常量: SM3_TJ[j] = T_j <<< (j mod 32), 编译期生成
+constexpr uint32_t sm3RotatedT(int j) {
+    uint32_t t = (j < 16) ? 0x79CC4519 : 0x7A879D8A;
+    int n = j % 32;
+    return n ? ((t << n) | (t >> (32 - n))) : t;
+}
+
+template <size_t... J>
+constexpr std::array<uint32_t, 64> sm3MakeTable(std::index_sequence<J...>) {
+    return {{sm3RotatedT((int)J)...}};
+}
+
+inline constexpr std::array<uint32_t, 64> SM3_TJ = sm3MakeTable(std::make_index_sequence<64>());
+
+// 流式SM3: init(构造/reset) -> update(任意长度, 可多次) -> finalize
+class SM3 {
+public:
+    static const size_t BLOCK_SIZE = 64;
+    static const size_t DIGEST_SIZE = 32;
+
+    // 中间状态导出格式(版本1), 多字节整数均为大端:
+    //   "SM3S"(4) | 版本(1) | 缓冲字节数n(1) | 总长度(8) | V[8](32) | 缓冲区内容(n)
+    // n < 64, 因此导出结果为46~109字节
+    static const uint8_t STATE_VERSION = 1;
+    static const size_t STATE_HEADER_SIZE = 46;
+    static const size_t MAX_STATE_SIZE = STATE_HEADER_SIZE + BLOCK_SIZE - 1;
+
+private:
+    static const uint32_t IV[8];
+
+    uint32_t V[8];
+
+    uint8_t buffer[BLOCK_SIZE];  // 未满一组的剩余字节
+    size_t bufferLen;
+    uint64_t totalLen;           // 已输入的总字节数
+
+    static inline uint32_t rotateLeft(uint32_t x, uint32_t n) {
+        n &= 31;
+        return (x << n) | (x >> ((32 - n) & 31));
+    }
+
+    // 布尔函数按轮号在编译期分成0~15和16~63两种, 轮函数里没有分支
+    template <bool LOW>
+    static inline uint32_t FF(uint32_t x, uint32_t y, uint32_t z) {
+        if constexpr (LOW) return x ^ y ^ z;
+        else return (x & y) | (x & z) | (y & z);
+    }
+
+    template <bool LOW>
+    static inline uint32_t GG(uint32_t x, uint32_t y, uint32_t z) {
+        if constexpr (LOW) return x ^ y ^ z;
+        else return (x & y) | (~x & z);
+    }
+
+    static inline uint32_t P0(uint32_t x) {
+        return x ^ rotateLeft(x, 9) ^ rotateLeft(x, 17);
+    }
+
+    static inline uint32_t P1(uint32_t x) {
+        return x ^ rotateLeft(x, 15) ^ rotateLeft(x, 23);
+    }
+
+    static inline uint32_t loadBE32(const uint8_t* p) {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+
+    // 第j轮. 不再每轮搬动8个寄存器: 只改写D、H并把B、F就地移位,
+    // 下一轮的A..D/E..H在s[]里整体"右转"一位, 下标都是编译期常量, 展开后s[]会全部放进寄存器.
+    // 消息扩展穿插在轮里: W只保留16个字的环形窗口, 第j轮顺便算出W[j+4]
+    template <int j>
+    static inline void round(uint32_t s[8], uint32_t w[16]) {
+        constexpr int a = (4 - j % 4) % 4;
+        constexpr int b = (a + 1) % 4, c = (a + 2) % 4, d = (a + 3) % 4;
+        constexpr int e = a + 4, f = b + 4, g = c + 4, h = d + 4;
+
+        if constexpr (j >= 12 && j < 64) {
+            constexpr int n = j + 4;
+            w[n % 16] = P1(w[(n - 16) % 16] ^ w[(n - 9) % 16] ^ rotateLeft(w[(n - 3) % 16], 15)) ^
+                        rotateLeft(w[(n - 13) % 16], 7) ^ w[(n - 6) % 16];
+        }
+        uint32_t Wj = w[j % 16];
+        uint32_t W1j = Wj ^ w[(j + 4) % 16];
+
+        uint32_t A12 = rotateLeft(s[a], 12);
+        uint32_t SS1 = rotateLeft(A12 + s[e] + SM3_TJ[j], 7);
+        uint32_t SS2 = SS1 ^ A12;
+        uint32_t TT1 = FF<(j < 16)>(s[a], s[b], s[c]) + s[d] + SS2 + W1j;
+        uint32_t TT2 = GG<(j < 16)>(s[e], s[f], s[g]) + s[h] + SS1 + Wj;
+        s[b] = rotateLeft(s[b], 9);
+        s[f] = rotateLeft(s[f], 19);
+        s[d] = TT1;
+        s[h] = P0(TT2);
+    }
+
+    template <int... J>
+    static inline void rounds(uint32_t s[8], uint32_t w[16], std::integer_sequence<int, J...>) {
+        (round<J>(s, w), ...);
+    }
+
+    void compress(const uint8_t* block) {
+        uint32_t w[16];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = loadBE32(block + i * 4);
+        }
+
+        uint32_t s[8];
+        std::memcpy(s, V, sizeof(s));
+        rounds(s, w, std::make_integer_sequence<int, 64>());
+
+        // 64是4的倍数, 结束时s[]的排列恰好回到A..H
+        for (int i = 0; i < 8; ++i) {
+            V[i] ^= s[i];
+        }
+    }
+
+public:
+    SM3() {
+        reset();
+    }
+
+    void reset() {
+        std::memcpy(V, IV, sizeof(IV));
+        bufferLen = 0;
+        totalLen = 0;
+    }
+
+    void update(const uint8_t* data, size_t len) {
+        totalLen += len;
+
+        // 先补齐上次剩下的半组
+        if (bufferLen > 0) {
+            size_t fill = BLOCK_SIZE - bufferLen;
+            if (len < fill) {
+                std::memcpy(buffer + bufferLen, data, len);
+                bufferLen += len;
+                return;
+            }
+            std::memcpy(buffer + bufferLen, data, fill);
+            compress(buffer);
+            data += fill;
+            len -= fill;
+            bufferLen = 0;
+        }
+
+        // 整组直接在调用者缓冲区上压缩
+        while (len >= BLOCK_SIZE) {
+            compress(data);
+            data += BLOCK_SIZE;
+            len -= BLOCK_SIZE;
+        }
+
+        if (len > 0) {
+            std::memcpy(buffer, data, len);
+            bufferLen = len;
+        }
+    }
+
+    // 填充并输出杂凑值, 之后需reset()才能复用
+    void finalize(uint8_t* hash) {
+        uint64_t bitLen = totalLen * 8;
+
+        buffer[bufferLen++] = 0x80;
+        if (bufferLen > BLOCK_SIZE - 8) {
+            std::memset(buffer + bufferLen, 0, BLOCK_SIZE - bufferLen);
+            compress(buffer);
+            bufferLen = 0;
+        }
+        std::memset(buffer + bufferLen, 0, BLOCK_SIZE - 8 - bufferLen);
+        for (int i = 0; i < 8; ++i) {
+            buffer[BLOCK_SIZE - 8 + i] = (uint8_t)(bitLen >> (56 - i * 8));
+        }
+        compress(buffer);
+        bufferLen = 0;
+
+        for (int i = 0; i < 8; ++i) {
+            hash[i * 4] = (V[i] >> 24) & 0xFF;
+            hash[i * 4 + 1] = (V[i] >> 16) & 0xFF;
+            hash[i * 4 + 2] = (V[i] >> 8) & 0xFF;
+            hash[i * 4 + 3] = V[i] & 0xFF;
+        }
+    }
+
+    // 导出当前中间状态, out至少MAX_STATE_SIZE字节, 返回实际写入的字节数.
+    // 另一个进程/机器上importState后继续update, 结果与不中断完全相同
+    size_t exportState(uint8_t* out) const {
+        std::memcpy(out, "SM3S", 4);
+        out[4] = STATE_VERSION;
+        out[5] = (uint8_t)bufferLen;
+        for (int i = 0; i < 8; ++i) {
+            out[6 + i] = (uint8_t)(totalLen >> (56 - i * 8));
+        }
+        for (int i = 0; i < 8; ++i) {
+            out[14 + i * 4] = (uint8_t)(V[i] >> 24);
+            out[14 + i * 4 + 1] = (uint8_t)(V[i] >> 16);
+            out[14 + i * 4 + 2] = (uint8_t)(V[i] >> 8);
+            out[14 + i * 4 + 3] = (uint8_t)V[i];
+        }
+        std::memcpy(out + STATE_HEADER_SIZE, buffer, bufferLen);
+        return STATE_HEADER_SIZE + bufferLen;
+    }
+
+    // 从exportState的结果恢复; 格式、版本或长度不一致时返回false, 当前状态保持不变
+    bool importState(const uint8_t* in, size_t len) {
+        if (len < STATE_HEADER_SIZE || std::memcmp(in, "SM3S", 4) != 0 || in[4] != STATE_VERSION) {
+            return false;
+        }
+        size_t n = in[5];
+        uint64_t total = 0;
+        for (int i = 0; i < 8; ++i) {
+            total = (total << 8) | in[6 + i];
+        }
+        // 缓冲区里只会有不足一组的尾部, 其长度必然等于总长度模64
+        if (n >= BLOCK_SIZE || len != STATE_HEADER_SIZE + n || total % BLOCK_SIZE != n) {
+            return false;
+        }
+
+        for (int i = 0; i < 8; ++i) {
+            V[i] = loadBE32(in + 14 + i * 4);
+        }
+        totalLen = total;
+        bufferLen = n;
+        std::memcpy(buffer, in + STATE_HEADER_SIZE, n);
+        return true;
+    }
+};
+
+inline const uint32_t SM3::IV[8] = {
+    0x7380166F, 0x4914B2B9, 0x172442D7, 0xDA8A0600,
+    0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
+};
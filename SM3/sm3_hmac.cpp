@@ -0,0 +1,38 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include "sm3_hmac.h"
+
+static void printHex(const char* label, const uint8_t* data, size_t len) {
+    std::cout << label;
+    for (size_t i = 0; i < len; ++i) {
+        printf("%02x", data[i]);
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    const char* key = "key";
+    const char* msg = "The quick brown fox jumps over the lazy dog";
+    uint8_t mac[SM3HMAC::MAC_SIZE];
+
+    // 同一密钥的HMAC对象可反复使用, ipad/opad状态只算一次
+    SM3HMAC hmac((const uint8_t*)key, strlen(key));
+    hmac.mac((const uint8_t*)msg, strlen(msg), mac);
+    printHex("HMAC-SM3: ", mac, sizeof(mac));
+
+    // 分段输入得到同样的结果
+    hmac.update((const uint8_t*)msg, 10);
+    hmac.update((const uint8_t*)msg + 10, strlen(msg) - 10);
+    hmac.finalize(mac);
+    printHex("HMAC-SM3 (分段): ", mac, sizeof(mac));
+
+    // KDF: 由共享秘密Z派生80字节密钥
+    uint8_t z[64];
+    for (int i = 0; i < 64; ++i) z[i] = (uint8_t)i;
+    uint8_t k[80];
+    sm3_kdf(z, sizeof(z), k, sizeof(k));
+    printHex("KDF(Z, 80): ", k, sizeof(k));
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "sm3.h"
+
+// HMAC-SM3: HMAC(K, m) = H((K ^ opad) || H((K ^ ipad) || m))
+// 构造时把 K^ipad、K^opad 各压缩一次并保存中间状态, 之后每条消息只需复制这两个上下文,
+// 每次MAC省掉两次压缩. 同一个密钥的对象可以长期持有, 反复 reset/update/finalize.
+class SM3HMAC {
+public:
+    static const size_t MAC_SIZE = SM3::DIGEST_SIZE;
+
+    SM3HMAC(const uint8_t* key, size_t keyLen) {
+        uint8_t k[SM3::BLOCK_SIZE] = {0};
+        if (keyLen > SM3::BLOCK_SIZE) {
+            // 长于一个分组的密钥先做一次杂凑
+            SM3 h;
+            h.update(key, keyLen);
+            h.finalize(k);
+        } else if (keyLen > 0) {
+            std::memcpy(k, key, keyLen);
+        }
+
+        uint8_t pad[SM3::BLOCK_SIZE];
+        for (size_t i = 0; i < SM3::BLOCK_SIZE; ++i) pad[i] = k[i] ^ 0x36;
+        innerInit.update(pad, SM3::BLOCK_SIZE);
+        for (size_t i = 0; i < SM3::BLOCK_SIZE; ++i) pad[i] = k[i] ^ 0x5C;
+        outerInit.update(pad, SM3::BLOCK_SIZE);
+
+        std::memset(k, 0, sizeof(k));
+        std::memset(pad, 0, sizeof(pad));
+        reset();
+    }
+
+    // 开始一条新消息: 从缓存的ipad状态复制
+    void reset() {
+        inner = innerInit;
+    }
+
+    void update(const uint8_t* data, size_t len) {
+        inner.update(data, len);
+    }
+
+    void finalize(uint8_t mac[MAC_SIZE]) {
+        uint8_t ih[SM3::DIGEST_SIZE];
+        inner.finalize(ih);
+        SM3 outer = outerInit;
+        outer.update(ih, sizeof(ih));
+        outer.finalize(mac);
+        reset();
+    }
+
+    // 一次性计算整条消息的MAC
+    void mac(const uint8_t* data, size_t len, uint8_t out[MAC_SIZE]) {
+        reset();
+        update(data, len);
+        finalize(out);
+    }
+
+private:
+    SM3 innerInit;  // 已吸收 K^ipad 的状态
+    SM3 outerInit;  // 已吸收 K^opad 的状态
+    SM3 inner;
+};
+
+// SM2使用的密钥派生函数(GM/T 0003.4): K = H(Z||ct=1) || H(Z||ct=2) || ..., 截取klen字节
+// Z只吸收一次, 每个计数器从该前缀状态复制, 只需再压缩包含计数器的最后一组
+class SM3KDF {
+public:
+    SM3KDF(const uint8_t* z, size_t zlen) {
+        prefix.update(z, zlen);
+    }
+
+    // 在已有前缀之后追加数据(如SM2解密时的 x2||y2 可分段输入)
+    void update(const uint8_t* data, size_t len) {
+        prefix.update(data, len);
+    }
+
+    void derive(uint8_t* out, size_t klen) const {
+        uint8_t block[SM3::DIGEST_SIZE];
+        for (uint32_t ct = 1; klen > 0; ++ct) {
+            uint8_t counter[4] = {(uint8_t)(ct >> 24), (uint8_t)(ct >> 16), (uint8_t)(ct >> 8), (uint8_t)ct};
+            SM3 h = prefix;
+            h.update(counter, sizeof(counter));
+            size_t n = klen < SM3::DIGEST_SIZE ? klen : SM3::DIGEST_SIZE;
+            if (n == SM3::DIGEST_SIZE) {
+                h.finalize(out);
+            } else {
+                h.finalize(block);
+                std::memcpy(out, block, n);
+            }
+            out += n;
+            klen -= n;
+        }
+        std::memset(block, 0, sizeof(block));
+    }
+
+private:
+    SM3 prefix;
+};
+
+inline void sm3_kdf(const uint8_t* z, size_t zlen, uint8_t* out, size_t klen) {
+    SM3KDF(z, zlen).derive(out, klen);
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <cstdio>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include "sm3_tree.h"
+
+static void printDigest(const char* label, const SM3TreeDigest& d) {
+    std::cout << label;
+    for (int i = 0; i < 32; ++i) {
+        printf("%02x", d.bytes[i]);
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    // 64MB测试数据, 1MB一个叶子
+    std::vector<uint8_t> data(64 << 20);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t)(i * 31 + (i >> 12));
+
+    // 至少用4个线程, 单核机器上也能验证多线程结果与单线程一致
+    unsigned cores = std::max(4u, std::thread::hardware_concurrency());
+    SM3TreeDigest one, many;
+    for (unsigned threads : {1u, cores}) {
+        SM3Tree tree;
+        auto start = std::chrono::steady_clock::now();
+        SM3TreeDigest d = tree.build(data.data(), data.size(), threads);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%u线程: %.1f MB/s\n", threads, data.size() / sec / 1e6);
+        (threads == 1 ? one : many) = d;
+    }
+    printDigest("SM3-TREE根: ", one);
+    std::cout << "多线程结果" << (one == many ? "一致" : "不一致!") << std::endl;
+
+    // 修改第5个叶子中的一个字节, 只重算该叶子到根的路径, 与整体重建比较
+    SM3Tree tree;
+    tree.build(data.data(), data.size());
+    size_t leaf = 5;
+    data[leaf * tree.getLeafSize() + 123] ^= 0xFF;
+    tree.updateLeaf(leaf, data.data() + leaf * tree.getLeafSize(), tree.getLeafSize());
+
+    SM3Tree rebuilt;
+    rebuilt.build(data.data(), data.size());
+    printDigest("修改后的根: ", tree.root());
+    std::cout << "增量更新" << (tree.root() == rebuilt.root() ? "与重建一致" : "与重建不一致!") << std::endl;
+    return 0;
+}
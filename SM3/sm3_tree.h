@@ -0,0 +1,158 @@
+#pragma once
+
+// SM3树杂凑(SM3-TREE): 把输入按固定大小切成叶子, 叶子在线程池上并行杂凑, 再两两合并成Merkle根.
+// 输出与普通SM3不同, 用独立的 SM3TreeDigest 类型表示, 不能与SM3摘要混用.
+//
+// 域分离(每次杂凑的第一个字节区分用途, 叶子、内部节点、根之间不可能互相伪造):
+//   叶子     leaf_i = SM3(0x00 || chunk_i)                     chunk_i为第i个leafSize字节(最后一个可以更短)
+//   内部节点 node   = SM3(0x01 || left || right)
+//                    某层节点数为奇数时, 最后一个节点原样提升到上一层
+//   根       root   = SM3(0x02 || leafSize(8字节大端) || totalLen(8字节大端) || top)
+//                    top为最顶层的唯一节点; 空输入视为一个空叶子
+// 保留全部中间节点, 修改某个叶子后只需重算它到根的路径.
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "sm3.h"
+
+struct SM3TreeDigest {
+    uint8_t bytes[SM3::DIGEST_SIZE];
+
+    bool operator==(const SM3TreeDigest& other) const {
+        return std::memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+    }
+    bool operator!=(const SM3TreeDigest& other) const {
+        return !(*this == other);
+    }
+};
+
+class SM3Tree {
+public:
+    static const size_t DEFAULT_LEAF_SIZE = 1 << 20;
+
+    explicit SM3Tree(size_t leafSize = DEFAULT_LEAF_SIZE) : leafSize(leafSize ? leafSize : DEFAULT_LEAF_SIZE), totalLen(0) {}
+
+    // 对整块数据建树; threads为0时使用全部硬件线程
+    SM3TreeDigest build(const uint8_t* data, size_t len, unsigned threads = 0) {
+        totalLen = len;
+        size_t leaves = len == 0 ? 1 : (len + leafSize - 1) / leafSize;
+        levels.assign(1, std::vector<Node>(leaves));
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = (unsigned)std::min<size_t>(threads, leaves);
+
+        // 各线程从共享计数器领取叶子编号, 叶子大小一致, 负载自然均衡
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < leaves; i = next++) {
+                size_t off = i * leafSize;
+                hashLeaf(data + off, std::min(leafSize, len - off), levels[0][i]);
+            }
+        };
+        if (len == 0) {
+            hashLeaf(data, 0, levels[0][0]);
+        } else if (threads <= 1) {
+            worker();
+        } else {
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < threads; ++t) pool.emplace_back(worker);
+            for (auto& th : pool) th.join();
+        }
+
+        // 上层节点数只有叶子数的一小部分, 串行合并即可
+        while (levels.back().size() > 1) {
+            const std::vector<Node>& below = levels.back();
+            std::vector<Node> above((below.size() + 1) / 2);
+            for (size_t k = 0; k < above.size(); ++k) {
+                combine(below, k, above[k]);
+            }
+            levels.push_back(std::move(above));
+        }
+        return root();
+    }
+
+    // 用新内容替换第index个叶子并沿路径重算到根. 除最后一个叶子外长度必须等于leafSize,
+    // 最后一个叶子可以改变长度(1~leafSize字节), 总长度随之更新. 参数不合法时树保持不变并返回false.
+    bool updateLeaf(size_t index, const uint8_t* chunk, size_t chunkLen) {
+        size_t leaves = leafCount();
+        if (index >= leaves || chunkLen > leafSize) return false;
+        bool last = index + 1 == leaves;
+        if (!last && chunkLen != leafSize) return false;
+        if (last && chunkLen == 0 && leaves > 1) return false;
+
+        if (last) totalLen = index * leafSize + chunkLen;
+        hashLeaf(chunk, chunkLen, levels[0][index]);
+
+        size_t k = index;
+        for (size_t lv = 1; lv < levels.size(); ++lv) {
+            k /= 2;
+            combine(levels[lv - 1], k, levels[lv][k]);
+        }
+        return true;
+    }
+
+    SM3TreeDigest root() const {
+        SM3TreeDigest d;
+        uint8_t prefix[17];
+        prefix[0] = 0x02;
+        for (int i = 0; i < 8; ++i) {
+            prefix[1 + i] = (uint8_t)((uint64_t)leafSize >> (56 - i * 8));
+            prefix[9 + i] = (uint8_t)((uint64_t)totalLen >> (56 - i * 8));
+        }
+        SM3 h;
+        h.update(prefix, sizeof(prefix));
+        if (!levels.empty()) {
+            h.update(levels.back()[0].hash, SM3::DIGEST_SIZE);
+        }
+        h.finalize(d.bytes);
+        return d;
+    }
+
+    size_t leafCount() const {
+        return levels.empty() ? 0 : levels[0].size();
+    }
+
+    size_t getLeafSize() const {
+        return leafSize;
+    }
+
+    uint64_t getTotalLen() const {
+        return totalLen;
+    }
+
+private:
+    struct Node {
+        uint8_t hash[SM3::DIGEST_SIZE];
+    };
+
+    size_t leafSize;
+    uint64_t totalLen;
+    std::vector<std::vector<Node>> levels;  // levels[0]为叶子, levels.back()只有一个节点
+
+    static void hashLeaf(const uint8_t* chunk, size_t len, Node& out) {
+        static const uint8_t tag = 0x00;
+        SM3 h;
+        h.update(&tag, 1);
+        h.update(chunk, len);
+        h.finalize(out.hash);
+    }
+
+    // 由下一层的第2k、2k+1个节点得到本层第k个节点; 没有右兄弟时直接提升
+    static void combine(const std::vector<Node>& below, size_t k, Node& out) {
+        if (2 * k + 1 >= below.size()) {
+            out = below[2 * k];
+            return;
+        }
+        static const uint8_t tag = 0x01;
+        SM3 h;
+        h.update(&tag, 1);
+        h.update(below[2 * k].hash, SM3::DIGEST_SIZE);
+        h.update(below[2 * k + 1].hash, SM3::DIGEST_SIZE);
+        h.finalize(out.hash);
+    }
+};
@@ -1,10 +1,13 @@
-#include <iostream>
-#include <vector>
-#include <iomanip>
-#include <sstream>
+#include <cstdio>
 #include <cstring>
+#include <cstdint>
 
-using namespace std;
+// 编译时加 -DSM3_TRACE 可打印填充、消息扩展和每轮迭代的中间值(调试用)
+#ifdef SM3_TRACE
+#define SM3_DEBUG(...) printf(__VA_ARGS__)
+#else
+#define SM3_DEBUG(...) ((void)0)
+#endif
 
 // 常量初始化
 const uint32_t IV[8] = {
@@ -12,78 +15,61 @@ const uint32_t IV[8] = {
     0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
 };
 
-const uint32_t T[64] = {
-    0x79CC4519, 0x79CC4519, 0x79CC4519, 0x79CC4519,
-    0x79CC4519, 0x79CC4519, 0x79CC4519, 0x79CC4519,
-    0x79CC4519, 0x79CC4519, 0x79CC4519, 0x79CC4519,
-    0x79CC4519, 0x79CC4519, 0x79CC4519, 0x79CC4519,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
-    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A
+// 轮常量T_j预先循环左移(j mod 32)位, 编译期生成, 压缩时直接查表
+constexpr uint32_t rotatedT(int j) {
+    uint32_t t = (j < 16) ? 0x79CC4519 : 0x7A879D8A;
+    int n = j % 32;
+    return n ? ((t << n) | (t >> (32 - n))) : t;
+}
+
+struct RotatedTTable {
+    uint32_t v[64];
+    constexpr RotatedTTable() : v() {
+        for (int j = 0; j < 64; ++j) v[j] = rotatedT(j);
+    }
 };
 
+constexpr RotatedTTable TJ;
+
 // 循环左移
-uint32_t rotateLeft(uint32_t x, int n) {
-    return (x << n) | (x >> (32 - n));
+static inline uint32_t rotateLeft(uint32_t x, int n) {
+    n &= 31;
+    return (x << n) | (x >> ((32 - n) & 31));
 }
 
-// 布尔函数FF
-uint32_t FF(uint32_t x, uint32_t y, uint32_t z, int j) {
-    return (j < 16) ? (x ^ y ^ z) : ((x & y) | (x & z) | (y & z));
+// 布尔函数FF/GG: 0~15轮和16~63轮分开写, 轮循环里不再判断j
+static inline uint32_t FF0(uint32_t x, uint32_t y, uint32_t z) {
+    return x ^ y ^ z;
 }
 
-// 布尔函数GG
-uint32_t GG(uint32_t x, uint32_t y, uint32_t z, int j) {
-    return (j < 16) ? (x ^ y ^ z) : ((x & y) | (~x & z));
+static inline uint32_t FF1(uint32_t x, uint32_t y, uint32_t z) {
+    return (x & y) | (x & z) | (y & z);
+}
+
+static inline uint32_t GG0(uint32_t x, uint32_t y, uint32_t z) {
+    return x ^ y ^ z;
+}
+
+static inline uint32_t GG1(uint32_t x, uint32_t y, uint32_t z) {
+    return (x & y) | (~x & z);
 }
 
 // 压缩函数P0
-uint32_t P0(uint32_t x) {
+static inline uint32_t P0(uint32_t x) {
     return x ^ rotateLeft(x, 9) ^ rotateLeft(x, 17);
 }
 
 // 压缩函数P1
-uint32_t P1(uint32_t x) {
+static inline uint32_t P1(uint32_t x) {
     return x ^ rotateLeft(x, 15) ^ rotateLeft(x, 23);
 }
 
-// 填充消息
-vector<uint8_t> padding(const vector<uint8_t>& message) {
-    vector<uint8_t> paddedMessage = message;
-    size_t originalBitLength = message.size() * 8;
-
-    // 添加一个1位
-    paddedMessage.push_back(0x80);
-
-    // 填充0直到长度满足条件
-    while ((paddedMessage.size() * 8) % 512 != 448) {
-        paddedMessage.push_back(0x00);
-    }
-
-    // 添加原始消息长度
-    for (int i = 7; i >= 0; --i) {
-        paddedMessage.push_back((originalBitLength >> (i * 8)) & 0xFF);
-    }
-
-    return paddedMessage;
-}
-
-// 消息扩展
-vector<uint32_t> messageExpansion(const vector<uint8_t>& block) {
-    vector<uint32_t> W(68);
-    vector<uint32_t> W1(64);
-
+// 消息扩展: 结果写入调用者提供的W[68]、W1[64]
+static void messageExpansion(const uint8_t block[64], uint32_t W[68], uint32_t W1[64]) {
     // 将消息分组为16个字
     for (int i = 0; i < 16; ++i) {
-        W[i] = (block[i * 4] << 24) | (block[i * 4 + 1] << 16) |
-               (block[i * 4 + 2] << 8) | block[i * 4 + 3];
+        W[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
     }
 
     // 扩展消息
@@ -97,58 +83,49 @@ vector<uint32_t> messageExpansion(const vector<uint8_t>& block) {
         W1[i] = W[i] ^ W[i + 4];
     }
 
-    // 打印扩展后的消息
-    cout << "扩展后的消息W: ";
-    for (int i = 0; i < 68; ++i) {
-        cout << hex << setw(8) << setfill('0') << W[i] << " ";
-    }
-    cout << endl;
-
-    cout << "扩展后的消息W1: ";
-    for (int i = 0; i < 64; ++i) {
-        cout << hex << setw(8) << setfill('0') << W1[i] << " ";
-    }
-    cout << endl;
-
-    return W;
+#ifdef SM3_TRACE
+    printf("扩展后的消息W: ");
+    for (int i = 0; i < 68; ++i) printf("%08x ", W[i]);
+    printf("\n扩展后的消息W1: ");
+    for (int i = 0; i < 64; ++i) printf("%08x ", W1[i]);
+    printf("\n");
+#endif
 }
 
-// 压缩函数
-void CF(vector<uint32_t>& V, const vector<uint32_t>& W) {
+// 压缩函数: 直接读取调用者缓冲区中的一个分组, 状态全部在栈上
+void CF(uint32_t V[8], const uint8_t block[64]) {
+    uint32_t W[68], W1[64];
+    messageExpansion(block, W, W1);
+
     uint32_t A = V[0], B = V[1], C = V[2], D = V[3];
     uint32_t E = V[4], F = V[5], G = V[6], H = V[7];
 
-    vector<uint32_t> W1(64);
-    // 计算W1
-    for (int i = 0; i < 64; ++i) {
-        W1[i] = W[i] ^ W[i + 4];
+#define SM3_ROUND(j, FF, GG)                                                   \
+    do {                                                                       \
+        uint32_t SS1 = rotateLeft(rotateLeft(A, 12) + E + TJ.v[j], 7);         \
+        uint32_t SS2 = SS1 ^ rotateLeft(A, 12);                                \
+        uint32_t TT1 = FF(A, B, C) + D + SS2 + W1[j];                          \
+        uint32_t TT2 = GG(E, F, G) + H + SS1 + W[j];                           \
+        D = C;                                                                 \
+        C = rotateLeft(B, 9);                                                  \
+        B = A;                                                                 \
+        A = TT1;                                                               \
+        H = G;                                                                 \
+        G = rotateLeft(F, 19);                                                 \
+        F = E;                                                                 \
+        E = P0(TT2);                                                           \
+        /* 输出迭代压缩的中间值 */                                             \
+        SM3_DEBUG("迭代压缩中间值 j=%d: %08x %08x %08x %08x %08x %08x %08x %08x\n", \
+                  j, A, B, C, D, E, F, G, H);                                  \
+    } while (0)
+
+    for (int j = 0; j < 16; ++j) {
+        SM3_ROUND(j, FF0, GG0);
     }
-
-    for (int j = 0; j < 64; ++j) {
-        uint32_t SS1 = rotateLeft((rotateLeft(A, 12) + E + rotateLeft(T[j], j % 32)), 7);
-        uint32_t SS2 = SS1 ^ rotateLeft(A, 12);
-        uint32_t TT1 = FF(A, B, C, j) + D + SS2 + W1[j];
-        uint32_t TT2 = GG(E, F, G, j) + H + SS1 + W[j];
-        D = C;
-        C = rotateLeft(B, 9);
-        B = A;
-        A = TT1;
-        H = G;
-        G = rotateLeft(F, 19);
-        F = E;
-        E = P0(TT2);
-
-        // 输出迭代压缩的中间值
-        cout << "迭代压缩中间值 j=" << dec << j << ": ";
-        cout << hex << setw(8) << setfill('0') << A << " "
-             << hex << setw(8) << setfill('0') << B << " "
-             << hex << setw(8) << setfill('0') << C << " "
-             << hex << setw(8) << setfill('0') << D << " "
-             << hex << setw(8) << setfill('0') << E << " "
-             << hex << setw(8) << setfill('0') << F << " "
-             << hex << setw(8) << setfill('0') << G << " "
-             << hex << setw(8) << setfill('0') << H << endl;
+    for (int j = 16; j < 64; ++j) {
+        SM3_ROUND(j, FF1, GG1);
     }
+#undef SM3_ROUND
 
     V[0] ^= A;
     V[1] ^= B;
@@ -160,44 +137,61 @@ void CF(vector<uint32_t>& V, const vector<uint32_t>& W) {
     V[7] ^= H;
 }
 
-// SM3哈希函数
-string SM3(const vector<uint8_t>& message) {
-    vector<uint8_t> paddedMessage = padding(message);
+// SM3哈希函数: 整组在原消息上压缩, 只有末尾(最多两组)拷到栈上填充
+void SM3(const uint8_t* message, size_t len, uint8_t digest[32]) {
+    uint32_t V[8];
+    memcpy(V, IV, sizeof(V));
+
+    // 分组处理
+    size_t full = len / 64 * 64;
+    for (size_t i = 0; i < full; i += 64) {
+        CF(V, message + i);
+    }
 
-    // 打印填充后的消息
-    cout << "填充后的消息: ";
-    for (uint8_t byte : paddedMessage) {
-        cout << hex << setw(2) << setfill('0') << (int)byte;
+    // 填充消息: 剩余字节 + 0x80 + 0...0 + 64位长度
+    uint8_t tail[128] = {0};
+    size_t rest = len - full;
+    size_t tailLen = (rest < 56) ? 64 : 128;
+    uint64_t bitLength = (uint64_t)len * 8;
+    memcpy(tail, message + full, rest);
+    tail[rest] = 0x80;
+    for (int i = 0; i < 8; ++i) {
+        tail[tailLen - 1 - i] = (uint8_t)(bitLength >> (i * 8));
     }
-    cout << endl;
 
-    vector<uint32_t> V(IV, IV + 8);
+#ifdef SM3_TRACE
+    printf("填充后的末尾分组: ");
+    for (size_t i = 0; i < tailLen; ++i) printf("%02x", tail[i]);
+    printf("\n");
+#endif
 
-    // 分组处理
-    for (size_t i = 0; i < paddedMessage.size(); i += 64) {
-        vector<uint8_t> block(paddedMessage.begin() + i, paddedMessage.begin() + i + 64);
-        vector<uint32_t> W = messageExpansion(block);
-        CF(V, W);
+    for (size_t i = 0; i < tailLen; i += 64) {
+        CF(V, tail + i);
     }
 
     // 输出最终的杂凑值
-    stringstream ss;
-    for (uint32_t v : V) {
-        ss << hex << setw(8) << setfill('0') << v;
+    for (int i = 0; i < 8; ++i) {
+        digest[i * 4] = (uint8_t)(V[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(V[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(V[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)V[i];
     }
-    return ss.str();
 }
 
 int main() {
     // 输入消息
-    string input = "abc";
-    vector<uint8_t> message(input.begin(), input.end());
+    const char* input = "abc";
 
     // 计算SM3哈希值
-    string hash = SM3(message);
+    uint8_t digest[32];
+    SM3((const uint8_t*)input, strlen(input), digest);
 
     // 输出最终的哈希值
-    cout << "最终的杂凑值: " << hash << endl;
+    printf("最终的杂凑值: ");
+    for (int i = 0; i < 32; ++i) {
+        printf("%02x", digest[i]);
+    }
+    printf("\n");
 
     return 0;
-}
\ No newline at end of file
+}
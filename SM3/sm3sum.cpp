@@ -0,0 +1,192 @@
+// sm3sum: 类似sha256sum的SM3文件杂凑工具, 多个文件在多核上并发计算, 并报告每个文件和总体的吞吐量.
+//
+// 编译: g++ -O2 -pthread sm3sum.cpp -o sm3sum
+// 用法: sm3sum [-r] [-d] [-j 线程数] [-q] 文件...
+//   默认   mmap整个文件并 madvise(MADV_SEQUENTIAL), 直接在映射上杂凑, 没有额外拷贝
+//   -r     改用4MB对齐缓冲区的大块read(), 并 posix_fadvise(SEQUENTIAL) 让内核预读
+//   -d     与-r合用, 以O_DIRECT打开绕过页缓存(文件系统不支持时自动退回普通读)
+//   -j N   并发线程数, 默认为CPU核数
+//   -q     不输出吞吐量
+// 杂凑结果按参数顺序输出到stdout, 格式与sha256sum相同; 吞吐量输出到stderr.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sm3.h"
+
+static const size_t READ_CHUNK = 4 << 20;
+static const size_t READ_ALIGN = 4096;
+
+struct FileJob {
+    const char* path;
+    uint8_t digest[SM3::DIGEST_SIZE];
+    uint64_t bytes;
+    double seconds;
+    std::string error;
+};
+
+struct Options {
+    bool useRead = false;
+    bool direct = false;
+    bool quiet = false;
+    unsigned threads = 0;
+};
+
+static bool hashMapped(int fd, uint64_t size, SM3& sm3, std::string& error) {
+    if (size == 0) return true;
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        error = std::string("mmap: ") + strerror(errno);
+        return false;
+    }
+    madvise(p, size, MADV_SEQUENTIAL);
+    madvise(p, size, MADV_WILLNEED);
+    sm3.update(static_cast<const uint8_t*>(p), size);
+    munmap(p, size);
+    return true;
+}
+
+static bool hashRead(int fd, SM3& sm3, uint64_t& bytes, std::string& error) {
+    void* buf = nullptr;
+    if (posix_memalign(&buf, READ_ALIGN, READ_CHUNK) != 0) {
+        error = "out of memory";
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    bool ok = true;
+    for (;;) {
+        ssize_t n = read(fd, buf, READ_CHUNK);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = std::string("read: ") + strerror(errno);
+            ok = false;
+            break;
+        }
+        if (n == 0) break;
+        sm3.update(static_cast<const uint8_t*>(buf), (size_t)n);
+        bytes += (uint64_t)n;
+    }
+    free(buf);
+    return ok;
+}
+
+static void hashFile(FileJob& job, const Options& opt) {
+    auto start = std::chrono::steady_clock::now();
+
+    int flags = O_RDONLY;
+#ifdef O_DIRECT
+    if (opt.useRead && opt.direct) flags |= O_DIRECT;
+#endif
+    int fd = open(job.path, flags);
+#ifdef O_DIRECT
+    if (fd < 0 && errno == EINVAL && (flags & O_DIRECT)) {
+        fd = open(job.path, O_RDONLY);
+    }
+#endif
+    if (fd < 0) {
+        job.error = strerror(errno);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        job.error = strerror(errno);
+        close(fd);
+        return;
+    }
+
+    SM3 sm3;
+    bool ok;
+    if (!opt.useRead && S_ISREG(st.st_mode)) {
+        job.bytes = (uint64_t)st.st_size;
+        ok = hashMapped(fd, job.bytes, sm3, job.error);
+    } else {
+        ok = hashRead(fd, sm3, job.bytes, job.error);
+    }
+    close(fd);
+    if (!ok) return;
+
+    sm3.finalize(job.digest);
+    job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void usage() {
+    fprintf(stderr, "用法: sm3sum [-r] [-d] [-j 线程数] [-q] 文件...\n");
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    int c;
+    while ((c = getopt(argc, argv, "rdj:qh")) != -1) {
+        switch (c) {
+        case 'r': opt.useRead = true; break;
+        case 'd': opt.direct = true; break;
+        case 'j': opt.threads = (unsigned)atoi(optarg); break;
+        case 'q': opt.quiet = true; break;
+        default: usage(); return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage();
+        return 2;
+    }
+    if (opt.direct && !opt.useRead) opt.useRead = true;
+
+    std::vector<FileJob> jobs(argc - optind);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].path = argv[optind + i];
+        jobs[i].bytes = 0;
+        jobs[i].seconds = 0;
+    }
+
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::min<size_t>(threads, jobs.size());
+
+    // 每个线程从共享计数器领取下一个文件
+    auto totalStart = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            hashFile(jobs[i], opt);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - totalStart).count();
+
+    int status = 0;
+    uint64_t totalBytes = 0;
+    for (const FileJob& job : jobs) {
+        if (!job.error.empty()) {
+            fprintf(stderr, "sm3sum: %s: %s\n", job.path, job.error.c_str());
+            status = 1;
+            continue;
+        }
+        for (size_t i = 0; i < SM3::DIGEST_SIZE; ++i) printf("%02x", job.digest[i]);
+        printf("  %s\n", job.path);
+        totalBytes += job.bytes;
+        if (!opt.quiet) {
+            fprintf(stderr, "%s: %llu 字节, %.1f MB/s\n", job.path, (unsigned long long)job.bytes,
+                    job.seconds > 0 ? job.bytes / job.seconds / 1e6 : 0.0);
+        }
+    }
+    if (!opt.quiet) {
+        fprintf(stderr, "总计: %zu 个文件, %llu 字节, %u 线程, %.1f MB/s\n", jobs.size(),
+                (unsigned long long)totalBytes, threads, totalSeconds > 0 ? totalBytes / totalSeconds / 1e6 : 0.0);
+    }
+    return status;
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+
+// 编译时加 -DSM4_TRACE 可打印每个轮密钥和每轮的中间值(调试用)
+#ifdef SM4_TRACE
+#define SM4_DEBUG(...) printf(__VA_ARGS__)
+#else
+#define SM4_DEBUG(...) ((void)0)
+#endif
+
+// SM4 S盒
+inline constexpr uint8_t SBox[256] = {
+    0xd6, 0x90, 0xe9, 0xfe, 0xcc, 0xe1, 0x3d, 0xb7, 0x16, 0xb6, 0x14, 0xc2, 0x28, 0xfb, 0x2c, 0x05,
+    0x2b, 0x67, 0x9a, 0x76, 0x2a, 0xbe, 0x04, 0xc3, 0xaa, 0x44, 0x13, 0x26, 0x49, 0x86, 0x06, 0x99,
+    0x9c, 0x42, 0x50, 0xf4, 0x91, 0xef, 0x98, 0x7a, 0x33, 0x54, 0x0b, 0x43, 0xed, 0xcf, 0xac, 0x62,
+    0xe4, 0xb3, 0x1c, 0xa9, 0xc9, 0x08, 0xe8, 0x95, 0x80, 0xdf, 0x94, 0xfa, 0x75, 0x8f, 0x3f, 0xa6,
+    0x47, 0x07, 0xa7, 0xfc, 0xf3, 0x73, 0x17, 0xba, 0x83, 0x59, 0x3c, 0x19, 0xe6, 0x85, 0x4f, 0xa8,
+    0x68, 0x6b, 0x81, 0xb2, 0x71, 0x64, 0xda, 0x8b, 0xf8, 0xeb, 0x0f, 0x4b, 0x70, 0x56, 0x9d, 0x35,
+    0x1e, 0x24, 0x0e, 0x5e, 0x63, 0x58, 0xd1, 0xa2, 0x25, 0x22, 0x7c, 0x3b, 0x01, 0x21, 0x78, 0x87,
+    0xd4, 0x00, 0x46, 0x57, 0x9f, 0xd3, 0x27, 0x52, 0x4c, 0x36, 0x02, 0xe7, 0xa0, 0xc4, 0xc8, 0x9e,
+    0xea, 0xbf, 0x8a, 0xd2, 0x40, 0xc7, 0x38, 0xb5, 0xa3, 0xf7, 0xf2, 0xce, 0xf9, 0x61, 0x15, 0xa1,
+    0xe0, 0xae, 0x5d, 0xa4, 0x9b, 0x34, 0x1a, 0x55, 0xad, 0x93, 0x32, 0x30, 0xf5, 0x8c, 0xb1, 0xe3,
+    0x1d, 0xf6, 0xe2, 0x2e, 0x82, 0x66, 0xca, 0x60, 0xc0, 0x29, 0x23, 0xab, 0x0d, 0x53, 0x4e, 0x6f,
+    0xd5, 0xdb, 0x37, 0x45, 0xde, 0xfd, 0x8e, 0x2f, 0x03, 0xff, 0x6a, 0x72, 0x6d, 0x6c, 0x5b, 0x51,
+    0x8d, 0x1b, 0xaf, 0x92, 0xbb, 0xdd, 0xbc, 0x7f, 0x11, 0xd9, 0x5c, 0x41, 0x1f, 0x10, 0x5a, 0xd8,
+    0x0a, 0xc1, 0x31, 0x88, 0xa5, 0xcd, 0x7b, 0xbd, 0x2d, 0x74, 0xd0, 0x12, 0xb8, 0xe5, 0xb4, 0xb0,
+    0x89, 0x69, 0x97, 0x4a, 0x0c, 0x96, 0x77, 0x7e, 0x65, 0xb9, 0xf1, 0x09, 0xc5, 0x6e, 0xc6, 0x84,
+    0x18, 0xf0, 0x7d, 0xec, 0x3a, 0xdc, 0x4d, 0x20, 0x79, 0xee, 0x5f, 0x3e, 0xd7, 0xcb, 0x39, 0x48
+};
+
+// FK常量
+inline const uint32_t FK[4] = {0xa3b1bac6, 0x56aa3350, 0x677d9197, 0xb27022dc};
+
+// CK常量
+inline const uint32_t CK[32] = {
+    0x00070e15, 0x1c232a31, 0x383f464d, 0x545b6269,
+    0x70777e85, 0x8c939aa1, 0xa8afb6bd, 0xc4cbd2d9,
+    0xe0e7eef5, 0xfc030a11, 0x181f262d, 0x343b4249,
+    0x50575e65, 0x6c737a81, 0x888f969d, 0xa4abb2b9,
+    0xc0c7ced5, 0xdce3eaf1, 0xf8ff060d, 0x141b2229,
+    0x30373e45, 0x4c535a61, 0x686f767d, 0x848b9299,
+    0xa0a7aeb5, 0xbcc3cad1, 0xd8dfe6ed, 0xf4fb0209,
+    0x10171e25, 0x2c333a41, 0x484f565d, 0x646b7279
+};
+
+// 循环左移
+inline constexpr uint32_t RotL(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+// 非线性变换τ
+inline uint32_t Tau(uint32_t x) {
+    return (SBox[x >> 24] << 24) | (SBox[(x >> 16) & 0xFF] << 16) |
+           (SBox[(x >> 8) & 0xFF] << 8) | SBox[x & 0xFF];
+}
+
+// 常数时间的τ: 一个字的4个字节并排在uint32_t里做GF(2^8)运算(SWAR), 不查SBox表, 也没有分支.
+// S(x) = A·I(A·x + C) + C, I为模 x^8+x^7+x^6+x^5+x^4+x^2+1 的求逆(x^254), C = 0xD3.
+// 比查表慢, 只用在KeyExpansion这类处理密钥、次数很少的地方
+inline constexpr uint32_t SM4_LANE_LSB = 0x01010101;
+
+// y = A·x + C; A的第j列为SM4_A_COLS[j]: 输入第j位为1时把这一列异或进结果
+inline constexpr uint8_t SM4_A_COLS[8] = {0xcb, 0x97, 0x2f, 0x5e, 0xbc, 0x79, 0xf2, 0xe5};
+
+inline constexpr uint32_t SM4AffineSWAR(uint32_t x) {
+    uint32_t y = 0xd3d3d3d3;
+    for (int j = 0; j < 8; ++j) {
+        y ^= ((x >> j) & SM4_LANE_LSB) * SM4_A_COLS[j];
+    }
+    return y;
+}
+
+// 四个字节分别相乘: 逐位移位-异或, 每步按b的对应比特生成整字节掩码
+inline constexpr uint32_t SM4GfMulSWAR(uint32_t a, uint32_t b) {
+    uint32_t r = 0;
+    for (int i = 0; i < 8; ++i) {
+        r ^= a & (((b >> i) & SM4_LANE_LSB) * 0xFF);
+        a = ((a & 0x7f7f7f7f) << 1) ^ (((a >> 7) & SM4_LANE_LSB) * 0xF5);
+    }
+    return r;
+}
+
+inline constexpr uint32_t TauCT(uint32_t x) {
+    uint32_t a = SM4AffineSWAR(x);
+    uint32_t a2 = SM4GfMulSWAR(a, a);
+    uint32_t a3 = SM4GfMulSWAR(a2, a);
+    uint32_t a12 = SM4GfMulSWAR(a3, a3);
+    a12 = SM4GfMulSWAR(a12, a12);
+    uint32_t t = SM4GfMulSWAR(a12, a3);       // a^15
+    for (int i = 0; i < 4; ++i) {
+        t = SM4GfMulSWAR(t, t);                // a^240
+    }
+    t = SM4GfMulSWAR(SM4GfMulSWAR(t, a12), a2); // a^254 = a^-1
+    return SM4AffineSWAR(t);
+}
+
+// 线性变换L
+inline constexpr uint32_t L(uint32_t x) {
+    return x ^ RotL(x, 2) ^ RotL(x, 10) ^ RotL(x, 18) ^ RotL(x, 24);
+}
+
+// 密钥扩展线性变换L'
+inline uint32_t LPrime(uint32_t x) {
+    return x ^ RotL(x, 13) ^ RotL(x, 23);
+}
+
+// 生成轮密钥. 中间值都由密钥导出, τ用常数时间的TauCT, 不按密钥查SBox表
+inline void KeyExpansion(const uint32_t MK[4], uint32_t rk[32]) {
+    uint32_t K[36];
+    for (int i = 0; i < 4; i++) {
+        K[i] = MK[i] ^ FK[i];
+    }
+    for (int i = 0; i < 32; i++) {
+        K[i + 4] = K[i] ^ LPrime(TauCT(K[i + 1] ^ K[i + 2] ^ K[i + 3] ^ CK[i]));
+        rk[i] = K[i + 4];
+        SM4_DEBUG("Round %2d Key: %08x\n", i + 1, rk[i]);
+    }
+}
+
+// 合成变换T = L∘τ的查表实现: L是线性的, 所以 L(τ(x)) = T0[x0] ^ T1[x1] ^ T2[x2] ^ T3[x3],
+// 其中Tk[b] = L(SBox[b]放在第k个字节). 四张表各256个字(1KB), 由SBox在编译期生成
+struct SM4TTable {
+    uint32_t t[4][256];
+    constexpr SM4TTable() : t() {
+        for (int b = 0; b < 256; ++b) {
+            for (int k = 0; k < 4; ++k) {
+                t[k][b] = L((uint32_t)SBox[b] << (24 - 8 * k));
+            }
+        }
+    }
+};
+
+inline constexpr SM4TTable SM4_T;
+
+inline uint32_t TTable(uint32_t x) {
+    return SM4_T.t[0][x >> 24] ^ SM4_T.t[1][(x >> 16) & 0xFF] ^
+           SM4_T.t[2][(x >> 8) & 0xFF] ^ SM4_T.t[3][x & 0xFF];
+}
+
+// 32轮迭代: 状态放在四个寄存器里轮流更新, 每次循环做4轮. 轮密钥按使用顺序以固定步长STEP读取,
+// 步长是编译期常量, 轮循环里没有加解密的判断
+template <int STEP>
+inline void SM4CryptImpl(const uint32_t input[4], uint32_t output[4], const uint32_t* k) {
+    uint32_t X0 = input[0], X1 = input[1], X2 = input[2], X3 = input[3];
+
+#define SM4_ROUND(i, A, B, C, D)                                                        \
+    do {                                                                                \
+        A ^= TTable(B ^ C ^ D ^ k[(i) * STEP]);                                         \
+        SM4_DEBUG("Round %2d %s: %08x %08x %08x %08x\n", (i) + 1, STEP > 0 ? "Encrypt" : "Decrypt", \
+                  B, C, D, A);                                                          \
+    } while (0)
+
+    for (int i = 0; i < 32; i += 4) {
+        SM4_ROUND(i, X0, X1, X2, X3);
+        SM4_ROUND(i + 1, X1, X2, X3, X0);
+        SM4_ROUND(i + 2, X2, X3, X0, X1);
+        SM4_ROUND(i + 3, X3, X0, X1, X2);
+    }
+#undef SM4_ROUND
+
+    output[0] = X3;
+    output[1] = X2;
+    output[2] = X1;
+    output[3] = X0;
+}
+
+// 加密/解密函数: 解密只是倒序使用轮密钥
+inline void SM4Crypt(const uint32_t input[4], uint32_t output[4], const uint32_t rk[32], bool encrypt) {
+    if (encrypt) {
+        SM4CryptImpl<1>(input, output, rk);
+    } else {
+        SM4CryptImpl<-1>(input, output, rk + 31);
+    }
+}
+
+// 按给定顺序使用轮密钥: 传入SM4Key::enc即加密, SM4Key::dec即解密
+inline void SM4CryptRounds(const uint32_t input[4], uint32_t output[4], const uint32_t rk[32]) {
+    SM4CryptImpl<1>(input, output, rk);
+}
+
+// 分组字节序: 16字节按大端拆成4个字
+inline uint32_t LoadBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+inline void StoreBE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+// 扩展好的密钥: 加密和解密(倒序)两份轮密钥各占两个缓存行, 密钥建立时一次算好,
+// 之后每个分组只需按顺序读取, 加解密走同一条代码路径
+struct SM4Key {
+    alignas(64) uint32_t enc[32];
+    alignas(64) uint32_t dec[32];
+
+    SM4Key() = default;
+
+    explicit SM4Key(const uint8_t key[16]) { set(key); }
+
+    explicit SM4Key(const uint32_t MK[4]) { set(MK); }
+
+    void set(const uint32_t MK[4]) {
+        KeyExpansion(MK, enc);
+        for (int i = 0; i < 32; ++i) dec[i] = enc[31 - i];
+    }
+
+    void set(const uint8_t key[16]) {
+        uint32_t MK[4];
+        for (int w = 0; w < 4; ++w) MK[w] = LoadBE32(key + w * 4);
+        set(MK);
+    }
+
+    const uint32_t* rounds(bool encrypt) const { return encrypt ? enc : dec; }
+};
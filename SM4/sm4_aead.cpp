@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "sm4_aead.h"
+
+static void fromHex(const char* hex, uint8_t* out) {
+    for (size_t i = 0; hex[2 * i]; ++i) {
+        unsigned v;
+        sscanf(hex + 2 * i, "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+}
+
+static void check(const char* name, const uint8_t* got, const char* expectHex, size_t len) {
+    uint8_t expect[64];
+    fromHex(expectHex, expect);
+    printf("%s: %s\n", name, std::memcmp(got, expect, len) == 0 ? "一致" : "不一致!");
+}
+
+int main() {
+    // RFC 8998 附录A的测试向量
+    uint8_t key[16], iv[12], aad[20], plain[64], out[64], back[64], tag[16];
+    fromHex("0123456789ABCDEFFEDCBA9876543210", key);
+    fromHex("00001234567800000000ABCD", iv);
+    fromHex("FEEDFACEDEADBEEFFEEDFACEDEADBEEFABADDAD2", aad);
+    fromHex("AAAAAAAAAAAAAAAABBBBBBBBBBBBBBBBCCCCCCCCCCCCCCCCDDDDDDDDDDDDDDDD"
+            "EEEEEEEEEEEEEEEEFFFFFFFFFFFFFFFFEEEEEEEEEEEEEEEEAAAAAAAAAAAAAAAA", plain);
+
+    sm4_gcm_encrypt(key, iv, 12, aad, 20, plain, out, 64, tag);
+    check("GCM密文", out, "17F399F08C67D5EE19D0DC9969C4BB7D5FD46FD3756489069157B282BB200735"
+                          "D82710CA5C22F0CCFA7CBF93D496AC15A56834CBCF98C397B4024A2691233B8D", 64);
+    check("GCM标签", tag, "83DE3541E4C2B58177E065A9BF7B62EC", 16);
+    bool ok = sm4_gcm_decrypt(key, iv, 12, aad, 20, out, back, 64, tag);
+    printf("GCM解密: %s\n", ok && std::memcmp(back, plain, 64) == 0 ? "通过" : "失败!");
+    out[5] ^= 1;
+    ok = sm4_gcm_decrypt(key, iv, 12, aad, 20, out, back, 64, tag);
+    printf("GCM篡改检测: %s\n", ok ? "未发现!" : "通过");
+
+    // 截短标签: 12~16字节可用, 0字节、过短或超过16字节一律拒绝
+    {
+        SM4GCM g(key);
+        uint8_t full[16], shortTag[32] = {0};
+        g.start(iv, 12);
+        g.aad(aad, 20);
+        g.encrypt(plain, out, 64);
+        g.finish(full);
+        int bad = 0;
+        for (size_t t = 0; t <= 32; ++t) {
+            g.start(iv, 12);
+            g.aad(aad, 20);
+            g.decrypt(out, back, 64);
+            std::memcpy(shortTag, full, 16);
+            bool accepted = g.verify(shortTag, t);
+            bool finished = g.finish(shortTag, t);
+            bool valid = t >= SM4GCM::MIN_TAG_SIZE && t <= SM4GCM::TAG_SIZE;
+            if (accepted != valid || finished != valid) ++bad;
+        }
+        // 超过2^36 - 32字节的明文在处理前就被拒绝(不会读写缓冲区), 之后标签也拿不到
+        g.start(iv, 12);
+        if (g.encrypt(nullptr, nullptr, (size_t)SM4GCM::MAX_TEXT_LEN + 1) || g.finish(full)) ++bad;
+        // 空IV被拒绝, 之后加密和标签都失败; 一次性接口也返回false
+        if (g.start(iv, 0) || g.encrypt(plain, out, 16) || g.finish(full)) ++bad;
+        if (sm4_gcm_encrypt(key, iv, 0, aad, 20, plain, out, 64, full)) ++bad;
+        if (sm4_gcm_decrypt(key, iv, 0, aad, 20, out, back, 64, full)) ++bad;
+        printf("GCM标签长度/明文长度/空IV检查: %s\n", bad == 0 ? "通过" : "失败!");
+    }
+
+    SM4CCM ccm(key);
+    ccm.encrypt(iv, 12, aad, 20, plain, out, 64, tag, 16);
+    check("CCM密文", out, "48AF93501FA62ADBCD414CCE6034D895DDA1BF8F132F042098661572E7483094"
+                          "FD12E518CE062C98ACEE28D95DF4416BED31A2F04476C18BB40C84A74B97DC5B", 64);
+    check("CCM标签", tag, "16842D4FA186F56AB33256971FA110F4", 16);
+    ok = ccm.decrypt(iv, 12, aad, 20, out, back, 64, tag, 16);
+    printf("CCM解密: %s\n", ok && std::memcmp(back, plain, 64) == 0 ? "通过" : "失败!");
+
+    // 吞吐: 16MB原地加解密
+    const size_t size = 16 << 20;
+    std::vector<uint8_t> buf(size);
+    std::mt19937 gen(2024);
+    for (auto& b : buf) b = (uint8_t)gen();
+
+    auto bench = [&](const char* name, auto fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-8s %8.1f MB/s\n", name, size / sec / 1e6);
+    };
+    SM4GCM gcm(key);
+    bench("GCM加密", [&] { gcm.start(iv, 12); gcm.encrypt(buf.data(), buf.data(), size); gcm.finish(tag); });
+    bench("GCM解密", [&] { gcm.start(iv, 12); gcm.decrypt(buf.data(), buf.data(), size); ok = gcm.verify(tag); });
+    printf("GCM大块往返: %s\n", ok ? "通过" : "失败!");
+    // 12字节nonce时长度字段只有3字节(最长16MB-1), 这里用11字节nonce
+    bench("CCM加密", [&] { ok = ccm.encrypt(iv, 11, nullptr, 0, buf.data(), buf.data(), size, tag, 16); });
+    bench("CCM解密", [&] { ok = ok && ccm.decrypt(iv, 11, nullptr, 0, buf.data(), buf.data(), size, tag, 16); });
+    printf("CCM大块往返: %s\n", ok ? "通过" : "失败!");
+    return 0;
+}
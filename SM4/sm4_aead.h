@@ -0,0 +1,517 @@
+#pragma once
+
+// SM4认证加密: SM4-GCM(NIST SP 800-38D)与SM4-CCM(SP 800-38C / RFC 3610), 与RFC 8998的测试向量一致.
+//
+// GCM的GHASH有两种实现, 运行时选择:
+//   PCLMUL   预先算好H^1..H^8, 每8个分组只做一次模约简: (Y^X0)·H^8 ^ X1·H^7 ^ ... ^ X7·H
+//            乘积先不约简地累加, 最后统一移位和约简(二者都是线性的)
+//   通用     按比特的常数时间乘法, 适用于任何CPU
+// 计数器加密和GHASH按256字节一批交替进行: 加密时刚写出的密文趁还在L1里立即做GHASH,
+// 解密时先对密文做GHASH再原地解密, 整个缓冲区只经过一次.
+//
+// CCM的CBC-MAC只能串行; 同样按批交替做MAC和计数器加密, 数据只过一遍缓存.
+//
+// 用法(GCM, 可分多次送入AAD和数据, 长度任意):
+//   SM4GCM gcm(key); gcm.start(iv, 12); gcm.aad(a, alen); gcm.encrypt(p, c, len); gcm.finish(tag);
+//   解密: ... gcm.decrypt(c, p, len); if (!gcm.verify(tag)) { 丢弃p }
+// 标签长度只接受12~16字节, 其他长度(包括0)finish/verify一律失败;
+// 一条消息的明文最长2^36 - 32字节(32位计数器的上限), 超出时encrypt/decrypt不做处理并返回false,
+// 之后的finish/verify也都失败. IV不能为空(SP 800-38D), 空IV时start返回false, 这条消息同样作废.
+// 由密钥导出的H = E_K(0)、E_K(J0)和逐组的CBC-MAC都走sm4_modes::crypt_block, 有GFNI/AES-NI时是常数时间的.
+// 用法(CCM, 一次性): SM4CCM ccm(key); ccm.encrypt(nonce, nlen, a, alen, p, c, len, tag, tlen);
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "sm4.h"
+#include "sm4_modes.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SM4_AEAD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace sm4_aead {
+
+// ---------------------------------------------------------------- 通用GHASH
+
+// GF(2^128)上的乘法, 按GCM的比特顺序(第0位为最高位), 约简多项式 x^128 + x^7 + x^2 + x + 1
+// 128次迭代中只用掩码选择, 没有依赖数据的分支和访存
+static inline void gf128_mul(uint64_t& xHi, uint64_t& xLo, uint64_t hHi, uint64_t hLo) {
+    uint64_t zHi = 0, zLo = 0, vHi = hHi, vLo = hLo;
+    for (int i = 0; i < 128; ++i) {
+        uint64_t bit = (i < 64 ? xHi >> (63 - i) : xLo >> (127 - i)) & 1;
+        uint64_t mask = 0 - bit;
+        zHi ^= vHi & mask;
+        zLo ^= vLo & mask;
+        uint64_t lsb = 0 - (vLo & 1);
+        vLo = (vLo >> 1) | (vHi << 63);
+        vHi = (vHi >> 1) ^ (0xE100000000000000ULL & lsb);
+    }
+    xHi = zHi;
+    xLo = zLo;
+}
+
+static inline void ghash_generic(uint8_t Y[16], uint64_t hHi, uint64_t hLo, const uint8_t* data, size_t nblocks) {
+    uint64_t yHi = sm4_modes::load_be64(Y), yLo = sm4_modes::load_be64(Y + 8);
+    for (; nblocks > 0; --nblocks, data += 16) {
+        yHi ^= sm4_modes::load_be64(data);
+        yLo ^= sm4_modes::load_be64(data + 8);
+        gf128_mul(yHi, yLo, hHi, hLo);
+    }
+    sm4_modes::store_be64(Y, yHi);
+    sm4_modes::store_be64(Y + 8, yLo);
+}
+
+// ---------------------------------------------------------------- PCLMUL GHASH
+
+#ifdef SM4_AEAD_X86
+
+// 分组整体字节反转后, GCM的反射比特序就变成普通的多项式系数序(只差整体左移一位)
+alignas(16) static const uint8_t BSWAP128[16] = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+
+static const int HPOWERS = 8;
+
+// 不约简的128x128位无进位乘法, 结果累加到(lo, mid, hi)
+#define SM4_AEAD_CLMUL_ACC(a, b, lo, mid, hi)                                  \
+    do {                                                                       \
+        lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(a, b, 0x00));              \
+        hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(a, b, 0x11));              \
+        mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(a, b, 0x01));            \
+        mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(a, b, 0x10));            \
+    } while (0)
+
+// 把累加的256位乘积左移一位再模约简(Intel的GCM白皮书中的方法)
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i gf128_reduce(__m128i lo, __m128i mid, __m128i hi) {
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    __m128i c0 = _mm_srli_epi32(lo, 31);
+    __m128i c1 = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    __m128i c2 = _mm_srli_si128(c0, 12);
+    c1 = _mm_slli_si128(c1, 4);
+    c0 = _mm_slli_si128(c0, 4);
+    lo = _mm_or_si128(lo, c0);
+    hi = _mm_or_si128(_mm_or_si128(hi, c1), c2);
+
+    __m128i t = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    __m128i t2 = _mm_srli_si128(t, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+    __m128i r = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+    r = _mm_xor_si128(r, t2);
+    return _mm_xor_si128(hi, _mm_xor_si128(lo, r));
+}
+
+__attribute__((target("pclmul,ssse3")))
+static void clmul_init(const uint8_t H[16], uint8_t htab[HPOWERS][16]) {
+    const __m128i bswap = _mm_load_si128((const __m128i*)BSWAP128);
+    __m128i h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)H), bswap);
+    __m128i p = h;
+    _mm_store_si128((__m128i*)htab[0], p);
+    for (int i = 1; i < HPOWERS; ++i) {
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        SM4_AEAD_CLMUL_ACC(p, h, lo, mid, hi);
+        p = gf128_reduce(lo, mid, hi);
+        _mm_store_si128((__m128i*)htab[i], p);
+    }
+}
+
+// htab[i] = H^(i+1)
+__attribute__((target("pclmul,ssse3")))
+static void ghash_clmul(uint8_t Y[16], const uint8_t htab[HPOWERS][16], const uint8_t* data, size_t nblocks) {
+    const __m128i bswap = _mm_load_si128((const __m128i*)BSWAP128);
+    __m128i y = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)Y), bswap);
+
+    for (; nblocks >= HPOWERS; nblocks -= HPOWERS, data += 16 * HPOWERS) {
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        for (int i = 0; i < HPOWERS; ++i) {
+            __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), bswap);
+            if (i == 0) x = _mm_xor_si128(x, y);
+            __m128i h = _mm_load_si128((const __m128i*)htab[HPOWERS - 1 - i]);
+            SM4_AEAD_CLMUL_ACC(x, h, lo, mid, hi);
+        }
+        y = gf128_reduce(lo, mid, hi);
+    }
+
+    // 不足8组的尾部同样聚合, 用H^n..H^1
+    if (nblocks > 0) {
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        for (size_t i = 0; i < nblocks; ++i) {
+            __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), bswap);
+            if (i == 0) x = _mm_xor_si128(x, y);
+            __m128i h = _mm_load_si128((const __m128i*)htab[nblocks - 1 - i]);
+            SM4_AEAD_CLMUL_ACC(x, h, lo, mid, hi);
+        }
+        y = gf128_reduce(lo, mid, hi);
+    }
+    _mm_storeu_si128((__m128i*)Y, _mm_shuffle_epi8(y, bswap));
+}
+
+#undef SM4_AEAD_CLMUL_ACC
+
+#endif // SM4_AEAD_X86
+
+inline bool has_clmul() {
+#ifdef SM4_AEAD_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+}
+
+// 常数时间比较认证标签
+static inline bool tag_equal(const uint8_t* a, const uint8_t* b, size_t len) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; ++i) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+} // namespace sm4_aead
+
+// ---------------------------------------------------------------- GCM
+
+class SM4GCM {
+public:
+    static const size_t TAG_SIZE = 16;
+    static const size_t MIN_TAG_SIZE = 12;
+    static const uint64_t MAX_TEXT_LEN = (1ULL << 36) - 32;  // 2^32 - 2个计数器分组
+
+    explicit SM4GCM(const uint8_t key[16]) : schedule(key) { init(); }
+
+    // 直接用缓存里已扩展好的密钥, 省掉KeyExpansion
+    explicit SM4GCM(const SM4Key& key) : schedule(key) { init(); }
+
+    // 开始一条新消息; 12字节IV最常用, 其他长度按标准用GHASH导出J0.
+    // ivLen为0时返回false, 之后的encrypt/decrypt/finish/verify都失败
+    bool start(const uint8_t* iv, size_t ivLen) {
+        std::memset(Y, 0, sizeof(Y));
+        partialLen = 0;
+        aadLen = textLen = 0;
+        inText = false;
+        invalid = ivLen == 0;
+        if (invalid) return false;
+        if (ivLen == 12) {
+            std::memcpy(J0, iv, 12);
+            J0[12] = J0[13] = J0[14] = 0;
+            J0[15] = 1;
+        } else {
+            hashBytes(iv, ivLen);
+            flushPartial();
+            uint8_t lenBlock[16] = {0};
+            sm4_modes::store_be64(lenBlock + 8, (uint64_t)ivLen * 8);
+            ghash(lenBlock, 1);
+            std::memcpy(J0, Y, 16);
+            std::memset(Y, 0, sizeof(Y));
+        }
+        std::memcpy(ctr, J0, 16);
+        inc32(ctr);
+        ksUsed = 16;
+        partialLen = 0;
+        return true;
+    }
+
+    // 附加认证数据, 必须在encrypt/decrypt之前送入
+    void aad(const uint8_t* data, size_t len) {
+        aadLen += len;
+        hashBytes(data, len);
+    }
+
+    bool encrypt(const uint8_t* in, uint8_t* out, size_t len) { return crypt(in, out, len, true); }
+    bool decrypt(const uint8_t* in, uint8_t* out, size_t len) { return crypt(in, out, len, false); }
+
+    // 输出标签(可截短到tagLen字节, 12~16); tagLen不合法、IV为空或明文超长时不写tag并返回false.
+    // 之后需要start才能处理下一条消息
+    bool finish(uint8_t* tag, size_t tagLen = TAG_SIZE) {
+        if (tagLen < MIN_TAG_SIZE || tagLen > TAG_SIZE || invalid) return false;
+        flushPartial();
+        uint8_t lenBlock[16];
+        sm4_modes::store_be64(lenBlock, aadLen * 8);
+        sm4_modes::store_be64(lenBlock + 8, textLen * 8);
+        ghash(lenBlock, 1);
+
+        uint8_t s[16];
+        sm4_modes::crypt_block(schedule.enc, J0, s);
+        sm4_modes::xor_bytes(s, s, Y, 16);
+        std::memcpy(tag, s, tagLen);
+        return true;
+    }
+
+    bool verify(const uint8_t* tag, size_t tagLen = TAG_SIZE) {
+        uint8_t expect[TAG_SIZE];
+        if (tagLen < MIN_TAG_SIZE || tagLen > TAG_SIZE || !finish(expect)) return false;
+        return sm4_aead::tag_equal(expect, tag, tagLen);
+    }
+
+private:
+    static const size_t CHUNK_BLOCKS = sm4_modes::CHUNK_BLOCKS;
+
+    SM4Key schedule;
+    alignas(16) uint8_t htab[8][16];  // PCLMUL用的H^1..H^8(字节反转后)
+    uint64_t hHi, hLo;                // 通用实现用的H
+    bool clmul;
+
+    uint8_t Y[16];        // GHASH状态
+    uint8_t J0[16];
+    uint8_t ctr[16];      // 下一个要用的计数器分组
+    uint8_t ks[16];       // 未用完的密钥流
+    unsigned ksUsed;
+    uint8_t partial[16];  // 凑不满一组、尚未做GHASH的字节(AAD或密文)
+    size_t partialLen;
+    uint64_t aadLen, textLen;
+    bool inText;
+    bool invalid;         // IV为空或明文超过MAX_TEXT_LEN, 本条消息作废
+
+    // 由密钥导出H及其各次幂
+    void init() {
+        uint8_t H[16] = {0};
+        sm4_modes::crypt_block(schedule.enc, H, H);
+        hHi = sm4_modes::load_be64(H);
+        hLo = sm4_modes::load_be64(H + 8);
+        static const bool detected = sm4_aead::has_clmul();
+        clmul = detected;
+#ifdef SM4_AEAD_X86
+        if (clmul) sm4_aead::clmul_init(H, htab);
+#endif
+        static const uint8_t zeroIv[12] = {0};
+        start(zeroIv, 12);
+    }
+
+    static void inc32(uint8_t block[16]) {
+        StoreBE32(block + 12, LoadBE32(block + 12) + 1);
+    }
+
+    void ghash(const uint8_t* data, size_t nblocks) {
+#ifdef SM4_AEAD_X86
+        if (clmul) {
+            sm4_aead::ghash_clmul(Y, htab, data, nblocks);
+            return;
+        }
+#endif
+        sm4_aead::ghash_generic(Y, hHi, hLo, data, nblocks);
+    }
+
+    void hashBytes(const uint8_t* data, size_t len) {
+        if (partialLen > 0) {
+            size_t n = 16 - partialLen < len ? 16 - partialLen : len;
+            std::memcpy(partial + partialLen, data, n);
+            partialLen += n;
+            data += n;
+            len -= n;
+            if (partialLen < 16) return;
+            ghash(partial, 1);
+            partialLen = 0;
+        }
+        ghash(data, len / 16);
+        partialLen = len % 16;
+        std::memcpy(partial, data + len - partialLen, partialLen);
+    }
+
+    // 不满一组的部分补零后做GHASH(AAD与密文之间、密文结束时)
+    void flushPartial() {
+        if (partialLen == 0) return;
+        std::memset(partial + partialLen, 0, 16 - partialLen);
+        ghash(partial, 1);
+        partialLen = 0;
+    }
+
+    // 上次剩下的密钥流逐字节用完; 密文字节同时进入GHASH缓冲, 两者的偏移始终相同
+    void cryptResidue(const uint8_t*& in, uint8_t*& out, size_t& len, bool enc) {
+        while (ksUsed < 16 && len > 0) {
+            uint8_t c = enc ? (uint8_t)(*in ^ ks[ksUsed]) : *in;
+            *out++ = *in++ ^ ks[ksUsed++];
+            partial[partialLen++] = c;
+            --len;
+        }
+        if (partialLen == 16) {
+            ghash(partial, 1);
+            partialLen = 0;
+        }
+    }
+
+    bool crypt(const uint8_t* in, uint8_t* out, size_t len, bool enc) {
+        if (invalid || (uint64_t)len > MAX_TEXT_LEN - textLen) {
+            invalid = true;
+            return false;
+        }
+        if (!inText) {
+            flushPartial();
+            inText = true;
+        }
+        textLen += len;
+        cryptResidue(in, out, len, enc);
+
+        uint8_t buf[CHUNK_BLOCKS * 16];
+        while (len >= 16) {
+            size_t n = len / 16 < CHUNK_BLOCKS ? len / 16 : CHUNK_BLOCKS;
+            for (size_t i = 0; i < n; ++i) {
+                std::memcpy(buf + i * 16, ctr, 16);
+                inc32(ctr);
+            }
+            sm4_modes::crypt_blocks(buf, buf, n, schedule.enc);
+            if (enc) {
+                sm4_modes::xor_bytes(out, in, buf, n * 16);
+                ghash(out, n);
+            } else {
+                ghash(in, n);
+                sm4_modes::xor_bytes(out, in, buf, n * 16);
+            }
+            in += n * 16;
+            out += n * 16;
+            len -= n * 16;
+        }
+
+        if (len > 0) {
+            sm4_modes::crypt_block(schedule.enc, ctr, ks);
+            inc32(ctr);
+            ksUsed = 0;
+            cryptResidue(in, out, len, enc);
+        }
+        return true;
+    }
+};
+
+// 一次性接口; 明文超长时返回false, 解密认证失败时把输出清零并返回false
+inline bool sm4_gcm_encrypt(const uint8_t key[16], const uint8_t* iv, size_t ivLen, const uint8_t* aad, size_t aadLen,
+                            const uint8_t* in, uint8_t* out, size_t len, uint8_t tag[16]) {
+    SM4GCM gcm(key);
+    if (!gcm.start(iv, ivLen)) return false;
+    gcm.aad(aad, aadLen);
+    return gcm.encrypt(in, out, len) && gcm.finish(tag);
+}
+
+inline bool sm4_gcm_decrypt(const uint8_t key[16], const uint8_t* iv, size_t ivLen, const uint8_t* aad, size_t aadLen,
+                            const uint8_t* in, uint8_t* out, size_t len, const uint8_t tag[16]) {
+    SM4GCM gcm(key);
+    if (!gcm.start(iv, ivLen)) return false;
+    gcm.aad(aad, aadLen);
+    if (!gcm.decrypt(in, out, len)) return false;  // 超长, out未被写入
+    if (!gcm.verify(tag)) {
+        std::memset(out, 0, len);
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- CCM
+
+class SM4CCM {
+public:
+    explicit SM4CCM(const uint8_t key[16]) : schedule(key) {}
+
+    explicit SM4CCM(const SM4Key& key) : schedule(key) {}
+
+    // nonce为7~13字节, 标签为4~16之间的偶数字节; 参数不合法时返回false
+    bool encrypt(const uint8_t* nonce, size_t nonceLen, const uint8_t* aad, size_t aadLen,
+                 const uint8_t* in, uint8_t* out, size_t len, uint8_t* tag, size_t tagLen) {
+        uint8_t ctr[16], mac[16];
+        if (!begin(nonce, nonceLen, aad, aadLen, len, tagLen, ctr, mac)) return false;
+
+        uint8_t ks[16];
+        unsigned num = 0;
+        for (size_t off = 0; off < len; off += CHUNK) {
+            size_t n = len - off < CHUNK ? len - off : CHUNK;
+            absorb(mac, in + off, n);
+            sm4_ctr_crypt(schedule, ctr, ks, &num, in + off, out + off, n);
+        }
+        end(nonce, nonceLen, mac, tag, tagLen);
+        return true;
+    }
+
+    // 认证失败时把输出清零并返回false
+    bool decrypt(const uint8_t* nonce, size_t nonceLen, const uint8_t* aad, size_t aadLen,
+                 const uint8_t* in, uint8_t* out, size_t len, const uint8_t* tag, size_t tagLen) {
+        uint8_t ctr[16], mac[16];
+        if (!begin(nonce, nonceLen, aad, aadLen, len, tagLen, ctr, mac)) return false;
+
+        uint8_t ks[16];
+        unsigned num = 0;
+        for (size_t off = 0; off < len; off += CHUNK) {
+            size_t n = len - off < CHUNK ? len - off : CHUNK;
+            sm4_ctr_crypt(schedule, ctr, ks, &num, in + off, out + off, n);
+            absorb(mac, out + off, n);
+        }
+        uint8_t expect[16];
+        end(nonce, nonceLen, mac, expect, tagLen);
+        if (!sm4_aead::tag_equal(expect, tag, tagLen)) {
+            std::memset(out, 0, len);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const size_t CHUNK = sm4_modes::CHUNK_BLOCKS * 16;
+
+    SM4Key schedule;
+
+    // CBC-MAC逐组吸收; 长度不足一组的末尾补零(数据在调用前已按批切好, 只有最后一批可能不满)
+    void absorb(uint8_t mac[16], const uint8_t* data, size_t len) {
+        for (; len > 0; data += 16) {
+            size_t n = len < 16 ? len : 16;
+            sm4_modes::xor_bytes(mac, mac, data, n);
+            sm4_modes::crypt_block(schedule.enc, mac, mac);
+            len -= n;
+        }
+    }
+
+    bool begin(const uint8_t* nonce, size_t nonceLen, const uint8_t* aad, size_t aadLen, size_t len,
+               size_t tagLen, uint8_t ctr[16], uint8_t mac[16]) {
+        if (nonceLen < 7 || nonceLen > 13) return false;
+        if (tagLen < 4 || tagLen > 16 || tagLen % 2) return false;
+        size_t q = 15 - nonceLen;
+        if (q < 8 && (uint64_t)len >> (8 * q)) return false;
+
+        // B0 = flags | nonce | 消息长度(q字节)
+        uint8_t b0[16];
+        b0[0] = (uint8_t)((aadLen ? 0x40 : 0) | ((tagLen - 2) / 2) << 3 | (q - 1));
+        std::memcpy(b0 + 1, nonce, nonceLen);
+        uint64_t l = len;
+        for (size_t i = 0; i < q; ++i, l >>= 8) b0[15 - i] = (uint8_t)l;
+        sm4_modes::crypt_block(schedule.enc, b0, mac);
+
+        // AAD前面加上它的长度编码, 整体补零到分组边界
+        if (aadLen) {
+            uint8_t block[16] = {0};
+            size_t head;
+            if (aadLen < 0xFF00) {
+                block[0] = (uint8_t)(aadLen >> 8);
+                block[1] = (uint8_t)aadLen;
+                head = 2;
+            } else if ((uint64_t)aadLen >> 32 == 0) {
+                block[0] = 0xFF;
+                block[1] = 0xFE;
+                StoreBE32(block + 2, (uint32_t)aadLen);
+                head = 6;
+            } else {
+                block[0] = 0xFF;
+                block[1] = 0xFF;
+                sm4_modes::store_be64(block + 2, aadLen);
+                head = 10;
+            }
+            size_t n = 16 - head < aadLen ? 16 - head : aadLen;
+            std::memcpy(block + head, aad, n);
+            absorb(mac, block, 16);
+            absorb(mac, aad + n, aadLen - n);
+        }
+
+        // 计数器A_i = flags | nonce | i, 加密数据从A_1开始, A_0留给标签
+        ctr[0] = (uint8_t)(q - 1);
+        std::memcpy(ctr + 1, nonce, nonceLen);
+        std::memset(ctr + 1 + nonceLen, 0, q);
+        ctr[15] = 1;
+        return true;
+    }
+
+    void end(const uint8_t* nonce, size_t nonceLen, const uint8_t mac[16], uint8_t* tag, size_t tagLen) {
+        uint8_t a0[16];
+        a0[0] = (uint8_t)(14 - nonceLen);
+        std::memcpy(a0 + 1, nonce, nonceLen);
+        std::memset(a0 + 1 + nonceLen, 0, 15 - nonceLen);
+        sm4_modes::crypt_block(schedule.enc, a0, a0);
+        sm4_modes::xor_bytes(tag, mac, a0, tagLen);
+    }
+};
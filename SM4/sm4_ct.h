@@ -0,0 +1,506 @@
+#pragma once
+
+// 常数时间SM4批量加解密: 不再用秘密数据查SBox表, 一次处理多个分组, 结果与SM4Crypt逐位一致.
+//
+// S盒的代数结构: S(x) = A·I(A·x + C) + C, I为GF(2^8)(模 x^8+x^7+x^6+x^5+x^4+x^2+1)上的求逆,
+// A为8x8比特矩阵, C = 0xD3. 据此有三种实现, 运行时按CPU选最快的一种:
+//   GFNI_AVX512 / GFNI_AVX2  借助域同构 φ 把SM4域上的求逆换成AES域上的求逆:
+//                            S(x) = (A·φ⁻¹)·I_aes(φA·x + φC) + C,
+//                            正好是一条 gf2p8affineqb 加一条 gf2p8affineinvqb, 每次16/8个分组
+//   AESNI                    AES的SubBytes = A_aes·I_aes(y) + 0x63, 前后仿射变换用pshufb半字节查表实现
+//                            (pshufb在寄存器内查表, 不访问内存, 是常数时间的), 每次8个分组
+//   BITSLICE                 纯C++比特切片: 32个分组的同一比特放进一个uint32_t, 求逆用 x^254 的加法链
+//                            (4次乘法 + 7次平方), 适用于任何CPU
+//
+// 用法: sm4_ct_crypt_blocks(in, out, nblocks, rk, encrypt);  in/out为nblocks*16字节, 可以是同一缓冲区
+//       rk也可以换成SM4Key, 内核只按顺序读轮密钥, 解密用的是预先倒排好的一份.
+//       有链式依赖的模式逐个分组计算时用 sm4_ct::crypt_block(backend, in, out, rk).
+// 轮密钥由KeyExpansion生成(每个密钥只做一次), 其中的τ用sm4.h里常数时间的TauCT, 密钥路径上同样不查SBox表.
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "sm4.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SM4_CT_X86 1
+#include <immintrin.h>
+#endif
+
+namespace sm4_ct {
+
+enum Backend { AUTO = 0, BITSLICE, AESNI, GFNI_AVX2, GFNI_AVX512 };
+
+// ---------------------------------------------------------------- 比特切片
+
+// 矩阵A的各行: 输出第i位 = 输入中 A_ROWS[i] 所选各位的异或
+static const uint8_t A_ROWS[8] = {0xa7, 0x4f, 0x9e, 0x3d, 0x7a, 0xf4, 0xe9, 0xd3};
+static const uint8_t A_CONST = 0xd3;
+
+template <typename T>
+struct Bitslice {
+    static const size_t BLOCKS = sizeof(T) * 8;
+
+    // y = A·x + C
+    static inline void affine(const T x[8], T y[8]) {
+        #pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            T acc = 0;
+            #pragma GCC unroll 8
+            for (int j = 0; j < 8; ++j) {
+                if ((A_ROWS[i] >> j) & 1) acc ^= x[j];
+            }
+            y[i] = ((A_CONST >> i) & 1) ? (T)~acc : acc;
+        }
+    }
+
+    // 模 x^8 = x^7+x^6+x^5+x^4+x^2+1 约减15项的乘积
+    static inline void reduce(T p[15], T r[8]) {
+        #pragma GCC unroll 7
+        for (int k = 14; k >= 8; --k) {
+            p[k - 8] ^= p[k];
+            p[k - 6] ^= p[k];
+            p[k - 4] ^= p[k];
+            p[k - 3] ^= p[k];
+            p[k - 2] ^= p[k];
+            p[k - 1] ^= p[k];
+        }
+        #pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) r[i] = p[i];
+    }
+
+    static inline void gfMul(const T a[8], const T b[8], T r[8]) {
+        T p[15] = {};
+        #pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            #pragma GCC unroll 8
+            for (int j = 0; j < 8; ++j) {
+                p[i + j] ^= a[i] & b[j];
+            }
+        }
+        reduce(p, r);
+    }
+
+    // 特征为2, 平方是线性的: 系数直接移到偶数次项
+    static inline void gfSqr(const T a[8], T r[8]) {
+        T p[15] = {};
+        #pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) p[2 * i] = a[i];
+        reduce(p, r);
+    }
+
+    // x^254 = x^-1 (0映射到0, 与S盒定义一致)
+    static inline void gfInv(const T x[8], T r[8]) {
+        T x2[8], x3[8], x12[8], x15[8], t[8];
+        gfSqr(x, x2);
+        gfMul(x2, x, x3);
+        gfSqr(x3, t);
+        gfSqr(t, x12);
+        gfMul(x12, x3, x15);
+        gfSqr(x15, t);
+        gfSqr(t, t);
+        gfSqr(t, t);
+        gfSqr(t, t);          // x^240
+        gfMul(t, x12, t);     // x^252
+        gfMul(t, x2, r);      // x^254
+    }
+
+    static inline void sbox(T x[8]) {
+        T a[8], b[8];
+        affine(x, a);
+        gfInv(a, b);
+        affine(b, x);
+    }
+
+    // s[w][j]: 各分组第w个字的第j位(1<<j)
+    static void pack(const uint8_t* in, size_t n, T s[4][32]) {
+        std::memset(s, 0, sizeof(T) * 4 * 32);
+        for (size_t k = 0; k < n; ++k) {
+            for (int w = 0; w < 4; ++w) {
+                uint32_t v = LoadBE32(in + k * 16 + w * 4);
+                for (int j = 0; j < 32; ++j) {
+                    s[w][j] |= (T)((v >> j) & 1) << k;
+                }
+            }
+        }
+    }
+
+    static void unpack(T s[4][32], uint8_t* out, size_t n) {
+        for (size_t k = 0; k < n; ++k) {
+            for (int w = 0; w < 4; ++w) {
+                uint32_t v = 0;
+                for (int j = 0; j < 32; ++j) {
+                    v |= (uint32_t)((s[w][j] >> k) & 1) << j;
+                }
+                StoreBE32(out + k * 16 + w * 4, v);
+            }
+        }
+    }
+
+    // 最多BLOCKS个分组; 字的循环移位只是切片下标的置换, 不需要任何运算
+    static void crypt(const uint8_t* in, uint8_t* out, size_t n, const uint32_t rk[32]) {
+        T X[4][32];
+        pack(in, n, X);
+
+        for (int i = 0; i < 32; ++i) {
+            uint32_t key = rk[i];
+            T* x0 = X[i % 4];
+            const T* x1 = X[(i + 1) % 4];
+            const T* x2 = X[(i + 2) % 4];
+            const T* x3 = X[(i + 3) % 4];
+
+            T t[32];
+            #pragma GCC unroll 32
+            for (int j = 0; j < 32; ++j) {
+                T keyBit = (T)0 - (T)((key >> j) & 1);
+                t[j] = x1[j] ^ x2[j] ^ x3[j] ^ keyBit;
+            }
+            #pragma GCC unroll 4
+            for (int b = 0; b < 4; ++b) {
+                sbox(t + 8 * b);
+            }
+            // X[i+4] = X[i] ^ L(t), L = t ^ t<<<2 ^ t<<<10 ^ t<<<18 ^ t<<<24
+            #pragma GCC unroll 32
+            for (int j = 0; j < 32; ++j) {
+                x0[j] ^= t[j] ^ t[(j + 30) % 32] ^ t[(j + 22) % 32] ^ t[(j + 14) % 32] ^ t[(j + 8) % 32];
+            }
+        }
+
+        // 32轮后X[0..3]依次为X32..X35, 输出为反序 (X35, X34, X33, X32)
+        T R[4][32];
+        for (int w = 0; w < 4; ++w) {
+            std::memcpy(R[w], X[3 - w], sizeof(R[w]));
+        }
+        unpack(R, out, n);
+    }
+};
+
+// ---------------------------------------------------------------- 单个分组
+// CBC/CFB加密、OFB等有链式依赖的模式每次只能算一个分组, 补零凑满一批太浪费.
+// 这里状态留在标量寄存器里, 每轮只把τ的输入放进向量寄存器过一遍S盒(GFNI或AES-NI), L仍用标量移位;
+// 没有这些指令时τ用sm4.h里SWAR的TauCT. 都不查表, 是常数时间的
+
+#define SM4_CT_CRYPT1(TAU)                                                                \
+    do {                                                                                  \
+        uint32_t X[4];                                                                    \
+        for (int w = 0; w < 4; ++w) X[w] = LoadBE32(in + w * 4);                          \
+        for (int i = 0; i < 32; ++i) {                                                    \
+            X[i % 4] ^= L(TAU(X[(i + 1) % 4] ^ X[(i + 2) % 4] ^ X[(i + 3) % 4] ^ rk[i])); \
+        }                                                                                 \
+        for (int w = 0; w < 4; ++w) StoreBE32(out + w * 4, X[3 - w]);                     \
+    } while (0)
+
+// ---------------------------------------------------------------- x86 SIMD
+
+#ifdef SM4_CT_X86
+
+// GFNI: S(x) = affineinv(affine(x, M1, 0x3E), M2, 0xD3)
+static const uint64_t GFNI_M1 = 0x4c287db91a22505dULL;
+static const uint64_t GFNI_M2 = 0xf3ab34a974a6b589ULL;
+#define SM4_CT_GFNI_C1 0x3e
+#define SM4_CT_GFNI_C2 0xd3
+
+// AES-NI: S(x) = post(AESENCLAST(pre(x), 0)), pre/post按高低半字节查表
+alignas(16) static const uint8_t AES_PRE_LO[16] = {
+    0x3e, 0xb2, 0x0e, 0x82, 0xbb, 0x37, 0x8b, 0x07, 0xa1, 0x2d, 0x91, 0x1d, 0x24, 0xa8, 0x14, 0x98};
+alignas(16) static const uint8_t AES_PRE_HI[16] = {
+    0x00, 0xdc, 0x2e, 0xf2, 0xc5, 0x19, 0xeb, 0x37, 0x08, 0xd4, 0x26, 0xfa, 0xcd, 0x11, 0xe3, 0x3f};
+alignas(16) static const uint8_t AES_POST_LO[16] = {
+    0x6c, 0xd4, 0xa6, 0x1e, 0x52, 0xea, 0x98, 0x20, 0x0b, 0xb3, 0xc1, 0x79, 0x35, 0x8d, 0xff, 0x47};
+alignas(16) static const uint8_t AES_POST_HI[16] = {
+    0x00, 0xe0, 0x50, 0xb0, 0x9d, 0x7d, 0xcd, 0x2d, 0xc0, 0x20, 0x90, 0x70, 0x5d, 0xbd, 0x0d, 0xed};
+// AESENCLAST自带ShiftRows, 之后用InvShiftRows把字节放回原位
+alignas(16) static const uint8_t AES_INV_SHIFT_ROWS[16] = {0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3};
+// 每个32位字内字节反转(分组为大端)
+alignas(16) static const uint8_t BSWAP32[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+
+// 4个寄存器各装4个分组(每128位一个分组), 128位通道内4x4转置后x[w]为这些分组的第w个字; 转置是自身的逆
+#define SM4_CT_TRANSPOSE(SUFFIX, x0, x1, x2, x3)             \
+    do {                                                     \
+        auto t0 = _mm##SUFFIX##_unpacklo_epi32(x0, x1);      \
+        auto t1 = _mm##SUFFIX##_unpackhi_epi32(x0, x1);      \
+        auto t2 = _mm##SUFFIX##_unpacklo_epi32(x2, x3);      \
+        auto t3 = _mm##SUFFIX##_unpackhi_epi32(x2, x3);      \
+        x0 = _mm##SUFFIX##_unpacklo_epi64(t0, t2);           \
+        x1 = _mm##SUFFIX##_unpackhi_epi64(t0, t2);           \
+        x2 = _mm##SUFFIX##_unpacklo_epi64(t1, t3);           \
+        x3 = _mm##SUFFIX##_unpackhi_epi64(t1, t3);           \
+    } while (0)
+
+// GCC 12的AVX-512头文件里, unpack/rol/broadcast_i32x4以自初始化的__Y作直通值, 内联后在-Wall下会误报
+// (可能)未初始化, 而且报在调用处, 用pragma压不住. 这里一律改用全1掩码的maskz形式, 直通值是显式的零向量
+#define SM4_CT_ALL16 ((__mmask16)0xFFFF)
+#define SM4_CT_ALL8 ((__mmask8)0xFF)
+#define SM4_CT_ROL512(x, n) _mm512_maskz_rol_epi32(SM4_CT_ALL16, x, n)
+#define SM4_CT_TRANSPOSE512(x0, x1, x2, x3)                             \
+    do {                                                                \
+        __m512i t0 = _mm512_maskz_unpacklo_epi32(SM4_CT_ALL16, x0, x1); \
+        __m512i t1 = _mm512_maskz_unpackhi_epi32(SM4_CT_ALL16, x0, x1); \
+        __m512i t2 = _mm512_maskz_unpacklo_epi32(SM4_CT_ALL16, x2, x3); \
+        __m512i t3 = _mm512_maskz_unpackhi_epi32(SM4_CT_ALL16, x2, x3); \
+        x0 = _mm512_maskz_unpacklo_epi64(SM4_CT_ALL8, t0, t2);          \
+        x1 = _mm512_maskz_unpackhi_epi64(SM4_CT_ALL8, t0, t2);          \
+        x2 = _mm512_maskz_unpacklo_epi64(SM4_CT_ALL8, t1, t3);          \
+        x3 = _mm512_maskz_unpackhi_epi64(SM4_CT_ALL8, t1, t3);          \
+    } while (0)
+
+__attribute__((target("avx512f,avx512bw,gfni")))
+static void crypt16_gfni_avx512(const uint8_t* in, uint8_t* out, const uint32_t rk[32]) {
+    const __m512i bswap = _mm512_maskz_broadcast_i32x4(SM4_CT_ALL16, _mm_load_si128((const __m128i*)BSWAP32));
+    const __m512i m1 = _mm512_set1_epi64((long long)GFNI_M1);
+    const __m512i m2 = _mm512_set1_epi64((long long)GFNI_M2);
+
+    __m512i x[4];
+    for (int w = 0; w < 4; ++w) {
+        x[w] = _mm512_shuffle_epi8(_mm512_loadu_si512(in + 64 * w), bswap);
+    }
+    SM4_CT_TRANSPOSE512(x[0], x[1], x[2], x[3]);
+
+    for (int i = 0; i < 32; ++i) {
+        __m512i k = _mm512_set1_epi32((int)rk[i]);
+        __m512i t = _mm512_xor_si512(_mm512_xor_si512(x[(i + 1) % 4], x[(i + 2) % 4]),
+                                     _mm512_xor_si512(x[(i + 3) % 4], k));
+        t = _mm512_gf2p8affine_epi64_epi8(t, m1, SM4_CT_GFNI_C1);
+        t = _mm512_gf2p8affineinv_epi64_epi8(t, m2, SM4_CT_GFNI_C2);
+        __m512i l = _mm512_xor_si512(_mm512_xor_si512(t, SM4_CT_ROL512(t, 2)),
+                                     _mm512_xor_si512(SM4_CT_ROL512(t, 10), SM4_CT_ROL512(t, 18)));
+        x[i % 4] = _mm512_xor_si512(x[i % 4], _mm512_xor_si512(l, SM4_CT_ROL512(t, 24)));
+    }
+
+    __m512i y0 = x[3], y1 = x[2], y2 = x[1], y3 = x[0];
+    SM4_CT_TRANSPOSE512(y0, y1, y2, y3);
+    _mm512_storeu_si512(out, _mm512_shuffle_epi8(y0, bswap));
+    _mm512_storeu_si512(out + 64, _mm512_shuffle_epi8(y1, bswap));
+    _mm512_storeu_si512(out + 128, _mm512_shuffle_epi8(y2, bswap));
+    _mm512_storeu_si512(out + 192, _mm512_shuffle_epi8(y3, bswap));
+}
+
+#undef SM4_CT_TRANSPOSE512
+#undef SM4_CT_ROL512
+#undef SM4_CT_ALL8
+#undef SM4_CT_ALL16
+
+__attribute__((target("avx2,gfni")))
+static inline __m256i rol32_avx2(__m256i x, int n) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n));
+}
+
+__attribute__((target("avx2,gfni")))
+static void crypt8_gfni_avx2(const uint8_t* in, uint8_t* out, const uint32_t rk[32]) {
+    const __m256i bswap = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)BSWAP32));
+    const __m256i m1 = _mm256_set1_epi64x((long long)GFNI_M1);
+    const __m256i m2 = _mm256_set1_epi64x((long long)GFNI_M2);
+
+    __m256i x[4];
+    for (int w = 0; w < 4; ++w) {
+        x[w] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(in + 32 * w)), bswap);
+    }
+    SM4_CT_TRANSPOSE(256, x[0], x[1], x[2], x[3]);
+
+    for (int i = 0; i < 32; ++i) {
+        __m256i k = _mm256_set1_epi32((int)rk[i]);
+        __m256i t = _mm256_xor_si256(_mm256_xor_si256(x[(i + 1) % 4], x[(i + 2) % 4]),
+                                     _mm256_xor_si256(x[(i + 3) % 4], k));
+        t = _mm256_gf2p8affine_epi64_epi8(t, m1, SM4_CT_GFNI_C1);
+        t = _mm256_gf2p8affineinv_epi64_epi8(t, m2, SM4_CT_GFNI_C2);
+        __m256i l = _mm256_xor_si256(_mm256_xor_si256(t, rol32_avx2(t, 2)),
+                                     _mm256_xor_si256(rol32_avx2(t, 10), rol32_avx2(t, 18)));
+        x[i % 4] = _mm256_xor_si256(x[i % 4], _mm256_xor_si256(l, rol32_avx2(t, 24)));
+    }
+
+    __m256i y0 = x[3], y1 = x[2], y2 = x[1], y3 = x[0];
+    SM4_CT_TRANSPOSE(256, y0, y1, y2, y3);
+    _mm256_storeu_si256((__m256i*)out, _mm256_shuffle_epi8(y0, bswap));
+    _mm256_storeu_si256((__m256i*)(out + 32), _mm256_shuffle_epi8(y1, bswap));
+    _mm256_storeu_si256((__m256i*)(out + 64), _mm256_shuffle_epi8(y2, bswap));
+    _mm256_storeu_si256((__m256i*)(out + 96), _mm256_shuffle_epi8(y3, bswap));
+}
+
+__attribute__((target("sse4.1,aes")))
+static inline __m128i rol32_sse(__m128i x, int n) {
+    return _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - n));
+}
+
+__attribute__((target("sse4.1,aes")))
+static inline __m128i sbox_aesni(__m128i x) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i preLo = _mm_load_si128((const __m128i*)AES_PRE_LO);
+    const __m128i preHi = _mm_load_si128((const __m128i*)AES_PRE_HI);
+    const __m128i postLo = _mm_load_si128((const __m128i*)AES_POST_LO);
+    const __m128i postHi = _mm_load_si128((const __m128i*)AES_POST_HI);
+    const __m128i invShift = _mm_load_si128((const __m128i*)AES_INV_SHIFT_ROWS);
+
+    __m128i y = _mm_xor_si128(_mm_shuffle_epi8(preLo, _mm_and_si128(x, mask)),
+                              _mm_shuffle_epi8(preHi, _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+    y = _mm_shuffle_epi8(_mm_aesenclast_si128(y, _mm_setzero_si128()), invShift);
+    return _mm_xor_si128(_mm_shuffle_epi8(postLo, _mm_and_si128(y, mask)),
+                         _mm_shuffle_epi8(postHi, _mm_and_si128(_mm_srli_epi16(y, 4), mask)));
+}
+
+// 两组各4个分组交错执行, 掩盖AESENCLAST的延迟
+__attribute__((target("sse4.1,aes")))
+static void crypt8_aesni(const uint8_t* in, uint8_t* out, const uint32_t rk[32]) {
+    const __m128i bswap = _mm_load_si128((const __m128i*)BSWAP32);
+
+    __m128i x[2][4];
+    for (int g = 0; g < 2; ++g) {
+        for (int w = 0; w < 4; ++w) {
+            x[g][w] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + 64 * g + 16 * w)), bswap);
+        }
+        SM4_CT_TRANSPOSE(, x[g][0], x[g][1], x[g][2], x[g][3]);
+    }
+
+    for (int i = 0; i < 32; ++i) {
+        __m128i k = _mm_set1_epi32((int)rk[i]);
+        for (int g = 0; g < 2; ++g) {
+            __m128i t = _mm_xor_si128(_mm_xor_si128(x[g][(i + 1) % 4], x[g][(i + 2) % 4]),
+                                      _mm_xor_si128(x[g][(i + 3) % 4], k));
+            t = sbox_aesni(t);
+            __m128i l = _mm_xor_si128(_mm_xor_si128(t, rol32_sse(t, 2)),
+                                      _mm_xor_si128(rol32_sse(t, 10), rol32_sse(t, 18)));
+            x[g][i % 4] = _mm_xor_si128(x[g][i % 4], _mm_xor_si128(l, rol32_sse(t, 24)));
+        }
+    }
+
+    for (int g = 0; g < 2; ++g) {
+        __m128i y0 = x[g][3], y1 = x[g][2], y2 = x[g][1], y3 = x[g][0];
+        SM4_CT_TRANSPOSE(, y0, y1, y2, y3);
+        _mm_storeu_si128((__m128i*)(out + 64 * g), _mm_shuffle_epi8(y0, bswap));
+        _mm_storeu_si128((__m128i*)(out + 64 * g + 16), _mm_shuffle_epi8(y1, bswap));
+        _mm_storeu_si128((__m128i*)(out + 64 * g + 32), _mm_shuffle_epi8(y2, bswap));
+        _mm_storeu_si128((__m128i*)(out + 64 * g + 48), _mm_shuffle_epi8(y3, bswap));
+    }
+}
+
+// 单个分组的τ, 轮函数见上方SM4_CT_CRYPT1
+__attribute__((target("sse4.1,gfni")))
+static inline uint32_t tau_gfni(uint32_t x) {
+    __m128i v = _mm_cvtsi32_si128((int)x);
+    v = _mm_gf2p8affine_epi64_epi8(v, _mm_set1_epi64x((long long)GFNI_M1), SM4_CT_GFNI_C1);
+    v = _mm_gf2p8affineinv_epi64_epi8(v, _mm_set1_epi64x((long long)GFNI_M2), SM4_CT_GFNI_C2);
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+__attribute__((target("sse4.1,aes")))
+static inline uint32_t tau_aesni(uint32_t x) {
+    return (uint32_t)_mm_cvtsi128_si32(sbox_aesni(_mm_cvtsi32_si128((int)x)));
+}
+
+__attribute__((target("sse4.1,gfni")))
+static void crypt1_gfni(const uint8_t* in, uint8_t* out, const uint32_t rk[32]) {
+    SM4_CT_CRYPT1(tau_gfni);
+}
+
+__attribute__((target("sse4.1,aes")))
+static void crypt1_aesni(const uint8_t* in, uint8_t* out, const uint32_t rk[32]) {
+    SM4_CT_CRYPT1(tau_aesni);
+}
+
+#undef SM4_CT_TRANSPOSE
+#undef SM4_CT_GFNI_C1
+#undef SM4_CT_GFNI_C2
+
+#endif // SM4_CT_X86
+
+inline Backend detect_backend() {
+#ifdef SM4_CT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("gfni") && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return GFNI_AVX512;
+    }
+    if (__builtin_cpu_supports("gfni") && __builtin_cpu_supports("avx2")) return GFNI_AVX2;
+    if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1")) return AESNI;
+#endif
+    return BITSLICE;
+}
+
+// 每种实现一次处理的分组数
+inline size_t batch_blocks(Backend b) {
+    switch (b) {
+    case GFNI_AVX512: return 16;
+    case GFNI_AVX2: return 8;
+    case AESNI: return 8;
+    default: return Bitslice<uint32_t>::BLOCKS;
+    }
+}
+
+// rk为按使用顺序排列的轮密钥(加密为rk0..rk31, 解密为倒序), 内核里不区分加解密
+inline void crypt_batch(Backend b, const uint8_t* in, uint8_t* out, size_t n, const uint32_t rk[32]) {
+#ifdef SM4_CT_X86
+    if (b != BITSLICE) {
+        // 不足一批时补零到整批, 只取回有效的分组
+        uint8_t buf[16 * 16];
+        const uint8_t* src = in;
+        uint8_t* dst = out;
+        size_t batch = b == GFNI_AVX512 ? 16 : 8;
+        if (n < batch) {
+            std::memset(buf, 0, batch * 16);
+            std::memcpy(buf, in, n * 16);
+            src = dst = buf;
+        }
+        switch (b) {
+        case GFNI_AVX512: crypt16_gfni_avx512(src, dst, rk); break;
+        case GFNI_AVX2: crypt8_gfni_avx2(src, dst, rk); break;
+        default: crypt8_aesni(src, dst, rk); break;
+        }
+        if (n < batch) {
+            std::memcpy(out, buf, n * 16);
+        }
+        return;
+    }
+#endif
+    Bitslice<uint32_t>::crypt(in, out, n, rk);
+}
+
+inline void crypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks, const uint32_t rk[32], Backend b) {
+    size_t batch = batch_blocks(b);
+    while (nblocks > 0) {
+        size_t n = nblocks < batch ? nblocks : batch;
+        crypt_batch(b, in, out, n, rk);
+        in += n * 16;
+        out += n * 16;
+        nblocks -= n;
+    }
+}
+
+// 单个分组, in/out可以相同
+inline void crypt_block(Backend b, const uint8_t in[16], uint8_t out[16], const uint32_t rk[32]) {
+#ifdef SM4_CT_X86
+    switch (b) {
+    case GFNI_AVX512:
+    case GFNI_AVX2: crypt1_gfni(in, out, rk); return;
+    case AESNI: crypt1_aesni(in, out, rk); return;
+    default: break;
+    }
+#else
+    (void)b;
+#endif
+    SM4_CT_CRYPT1(TauCT);
+}
+
+// 指定的实现超出CPU支持范围时降到检测到的实现(各实现按所需指令集从低到高排列)
+inline Backend resolve(Backend backend) {
+    static const Backend detected = detect_backend();
+    return backend == AUTO || backend > detected ? detected : backend;
+}
+
+#undef SM4_CT_CRYPT1
+
+} // namespace sm4_ct
+
+// 对nblocks个16字节分组做SM4加密(encrypt=true)或解密, rk为KeyExpansion得到的轮密钥
+// backend默认自动选择, 也可指定某个实现用于对比测试(CPU不支持时退回检测到的实现)
+inline void sm4_ct_crypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks, const uint32_t rk[32], bool encrypt,
+                                sm4_ct::Backend backend = sm4_ct::AUTO) {
+    uint32_t reversed[32];
+    if (!encrypt) {
+        for (int i = 0; i < 32; ++i) reversed[i] = rk[31 - i];
+    }
+    sm4_ct::crypt_blocks(in, out, nblocks, encrypt ? rk : reversed, sm4_ct::resolve(backend));
+}
+
+// 使用预先扩展好的SM4Key, 解密不必每次倒排轮密钥
+inline void sm4_ct_crypt_blocks(const uint8_t* in, uint8_t* out, size_t nblocks, const SM4Key& key, bool encrypt,
+                                sm4_ct::Backend backend = sm4_ct::AUTO) {
+    sm4_ct::crypt_blocks(in, out, nblocks, key.rounds(encrypt), sm4_ct::resolve(backend));
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+// SM4的分散/聚集(scatter-gather)接口: 一个报文由若干不连续的片段(struct iovec数组)组成时,
+// 不必先拷贝拼成连续缓冲区再加密.
+//
+// 输入和输出各是一个iovec数组, 两边的分段方式可以不同, 只要求总长度相同(否则返回false);
+// 原地加解密时输出直接传入同一个数组.
+// 两边片段的交叠部分是连续的, 直接交给sm4_modes.h里对应的字节流接口, 多分组内核照常成批处理;
+//   CTR/OFB/CFB: 密钥流余量通过iv/ks/num自然延续到下一个片段, 与整段连续调用的结果逐字节相同;
+//   CBC/ECB:     总长度须为16的倍数. 跨越片段边界的那个分组先聚集到栈上的16字节缓冲区,
+//                加解密后再分散写回, 其余整组原样走批量路径;
+//   GCM:         SM4GCM本身支持任意长度的多次调用, 这里只负责按片段喂数据, tag与连续调用一致.
+//
+// 用法: struct iovec v[3] = {{hdr, 20}, {body, 1400}, {trailer, 12}};
+//       sm4_ctr_crypt_iov(key, ctr, ks, &num, v, 3, v, 3);   // 原地
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <sys/uio.h>
+#include "sm4_modes.h"
+#include "sm4_aead.h"
+
+namespace sm4_iov {
+
+// 在iovec数组上顺序移动的读写位置, 自动跳过长度为0的片段
+struct Cursor {
+    const struct iovec* v;
+    size_t count;
+    size_t index;
+    size_t offset;
+
+    Cursor(const struct iovec* iov, size_t n) : v(iov), count(n), index(0), offset(0) { skip(); }
+
+    void skip() {
+        while (index < count && offset == v[index].iov_len) {
+            ++index;
+            offset = 0;
+        }
+    }
+    // 当前片段剩余的连续字节数, 到末尾时为0
+    size_t avail() const { return index < count ? v[index].iov_len - offset : 0; }
+    uint8_t* ptr() const { return static_cast<uint8_t*>(v[index].iov_base) + offset; }
+    void advance(size_t n) {
+        offset += n;
+        skip();
+    }
+    // 跨片段读出或写入n字节, 调用者保证剩余长度足够
+    void gather(uint8_t* dst, size_t n) {
+        while (n > 0) {
+            size_t m = avail() < n ? avail() : n;
+            std::memcpy(dst, ptr(), m);
+            dst += m;
+            n -= m;
+            advance(m);
+        }
+    }
+    void scatter(const uint8_t* src, size_t n) {
+        while (n > 0) {
+            size_t m = avail() < n ? avail() : n;
+            std::memcpy(ptr(), src, m);
+            src += m;
+            n -= m;
+            advance(m);
+        }
+    }
+};
+
+inline size_t total_length(const struct iovec* v, size_t n) {
+    size_t len = 0;
+    for (size_t i = 0; i < n; ++i) len += v[i].iov_len;
+    return len;
+}
+
+// 流式模式: 按输入与输出片段的交叠切成连续的小段依次调用fn(in, out, len), 余量由fn自己的状态接续
+template<class Fn>
+inline bool for_each_span(const struct iovec* src, size_t srcCount, const struct iovec* dst, size_t dstCount, Fn fn) {
+    if (total_length(src, srcCount) != total_length(dst, dstCount)) return false;
+    Cursor in(src, srcCount), out(dst, dstCount);
+    while (in.avail() > 0) {
+        size_t n = in.avail() < out.avail() ? in.avail() : out.avail();
+        fn(in.ptr(), out.ptr(), n);
+        in.advance(n);
+        out.advance(n);
+    }
+    return true;
+}
+
+// 分组模式: 两边都有连续的整组时批量调用fn, 跨边界的分组经栈上缓冲区聚集/分散后单独处理.
+// fn按顺序收到全部分组, 因此CBC的链接值照常传递; 原地时先读出整组再写回, 不会覆盖未读的输入
+template<class Fn>
+inline bool for_each_blocks(const struct iovec* src, size_t srcCount, const struct iovec* dst, size_t dstCount, Fn fn) {
+    using sm4_modes::BLOCK;
+    size_t len = total_length(src, srcCount);
+    if (len % BLOCK || total_length(dst, dstCount) != len) return false;
+    Cursor in(src, srcCount), out(dst, dstCount);
+    uint8_t block[BLOCK];
+    while (in.avail() > 0) {
+        size_t n = in.avail() < out.avail() ? in.avail() : out.avail();
+        n -= n % BLOCK;
+        if (n > 0) {
+            fn(in.ptr(), out.ptr(), n);
+            in.advance(n);
+            out.advance(n);
+        } else {
+            in.gather(block, BLOCK);
+            fn(block, block, BLOCK);
+            out.scatter(block, BLOCK);
+        }
+    }
+    return true;
+}
+
+} // namespace sm4_iov
+
+// ---------------------------------------------------------------- ECB / CBC
+
+inline bool sm4_ecb_encrypt_iov(const SM4Key& key, const struct iovec* src, size_t srcCount,
+                                const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_blocks(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_ecb_encrypt(key, in, out, n);
+    });
+}
+
+inline bool sm4_ecb_decrypt_iov(const SM4Key& key, const struct iovec* src, size_t srcCount,
+                                const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_blocks(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_ecb_decrypt(key, in, out, n);
+    });
+}
+
+inline bool sm4_cbc_encrypt_iov(const SM4Key& key, uint8_t iv[16], const struct iovec* src, size_t srcCount,
+                                const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_blocks(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_cbc_encrypt(key, iv, in, out, n);
+    });
+}
+
+inline bool sm4_cbc_decrypt_iov(const SM4Key& key, uint8_t iv[16], const struct iovec* src, size_t srcCount,
+                                const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_blocks(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_cbc_decrypt(key, iv, in, out, n);
+    });
+}
+
+// ---------------------------------------------------------------- CFB / OFB / CTR
+
+inline bool sm4_cfb_encrypt_iov(const SM4Key& key, uint8_t iv[16], unsigned* num, const struct iovec* src,
+                                size_t srcCount, const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_span(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_cfb_encrypt(key, iv, num, in, out, n);
+    });
+}
+
+inline bool sm4_cfb_decrypt_iov(const SM4Key& key, uint8_t iv[16], unsigned* num, const struct iovec* src,
+                                size_t srcCount, const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_span(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_cfb_decrypt(key, iv, num, in, out, n);
+    });
+}
+
+inline bool sm4_ofb_crypt_iov(const SM4Key& key, uint8_t iv[16], unsigned* num, const struct iovec* src,
+                              size_t srcCount, const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_span(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_ofb_crypt(key, iv, num, in, out, n);
+    });
+}
+
+inline bool sm4_ctr_crypt_iov(const SM4Key& key, uint8_t ctr[16], uint8_t ks[16], unsigned* num,
+                              const struct iovec* src, size_t srcCount, const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_span(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        sm4_ctr_crypt(key, ctr, ks, num, in, out, n);
+    });
+}
+
+// ---------------------------------------------------------------- GCM
+// 在gcm.start()/aad()之后调用, 之后照常finish()或verify(); IV为空或明文超长时由finish()/verify()报告失败
+
+inline bool sm4_gcm_encrypt_iov(SM4GCM& gcm, const struct iovec* src, size_t srcCount,
+                                const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_span(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        gcm.encrypt(in, out, n);
+    });
+}
+
+inline bool sm4_gcm_decrypt_iov(SM4GCM& gcm, const struct iovec* src, size_t srcCount,
+                                const struct iovec* dst, size_t dstCount) {
+    return sm4_iov::for_each_span(src, srcCount, dst, dstCount, [&](const uint8_t* in, uint8_t* out, size_t n) {
+        gcm.decrypt(in, out, n);
+    });
+}
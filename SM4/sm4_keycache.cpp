@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "sm4_keycache.h"
+#include "sm4_modes.h"
+
+// 模拟大量会话轮流发包: 每个包64字节CTR加密, 对比每包重新扩展密钥与从缓存取密钥的吞吐
+int main() {
+    const size_t sessions = 20000, packets = 500000, packetSize = 64;
+    std::mt19937_64 gen(2024);
+
+    std::vector<uint8_t> keys(sessions * 16);
+    for (auto& b : keys) b = (uint8_t)gen();
+
+    // 访问集中在少数活跃会话上(近似Zipf分布)
+    std::vector<uint64_t> ids(packets);
+    std::geometric_distribution<uint64_t> dis(1.0 / 2000);
+    for (auto& id : ids) id = dis(gen) % sessions;
+
+    uint8_t packet[packetSize], ctr[16], ks[16];
+    unsigned num;
+    std::memset(packet, 0x5a, sizeof(packet));
+
+    uint64_t check1 = 0, check2 = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t id : ids) {
+        SM4Key key(&keys[id * 16]);
+        std::memset(ctr, 0, 16);
+        num = 0;
+        sm4_ctr_crypt(key, ctr, ks, &num, packet, packet, packetSize);
+        check1 += packet[0];
+    }
+    double plain = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::memset(packet, 0x5a, sizeof(packet));
+    SM4KeyCache cache(8192);
+    start = std::chrono::steady_clock::now();
+    for (uint64_t id : ids) {
+        SM4KeyCache::KeyPtr key = cache.get(id, &keys[id * 16]);
+        std::memset(ctr, 0, 16);
+        num = 0;
+        sm4_ctr_crypt(*key, ctr, ks, &num, packet, packet, packetSize);
+        check2 += packet[0];
+    }
+    double cached = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("每包扩展密钥: %.2f M包/s\n", packets / plain / 1e6);
+    printf("LRU缓存(容量%zu): %.2f M包/s, 命中率%.1f%%\n", cache.capacity(), packets / cached / 1e6,
+           100.0 * cache.hits() / (cache.hits() + cache.misses()));
+    printf("两种方式结果%s\n", check1 == check2 ? "一致" : "不一致!");
+
+    // 只看取密钥本身的开销
+    uint32_t sink = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t id : ids) sink += SM4Key(&keys[id * 16]).dec[0];
+    double expandOnly = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (uint64_t id : ids) sink -= cache.get(id, &keys[id * 16])->dec[0];
+    double lookupOnly = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("取一次密钥: 扩展%.0f ns, 缓存%.0f ns (校验%u)\n", expandOnly / packets * 1e9, lookupOnly / packets * 1e9, sink);
+
+    // 淘汰与替换
+    SM4KeyCache small(2);
+    small.get(1, &keys[16]);
+    small.get(2, &keys[32]);
+    small.get(1, &keys[16]);
+    small.get(3, &keys[48]);  // 淘汰最久未用的2
+    printf("淘汰检查: %s\n", small.find(2) == nullptr && small.find(1) && small.find(3) ? "通过" : "失败!");
+    return 0;
+}
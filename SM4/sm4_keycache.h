@@ -0,0 +1,135 @@
+#pragma once
+
+// 按密钥ID缓存扩展好的SM4Key, 容量固定, 满了淘汰最久未使用的(LRU).
+// 会话密钥很多、轮换频繁时, 每个包只需一次查表就能拿到加解密两份轮密钥, 不再重复做KeyExpansion.
+//
+// 返回shared_ptr: 条目被淘汰或删除后, 正在使用它的线程仍持有有效的副本;
+// 最后一个引用释放时清零轮密钥再释放内存.
+// 所有成员函数都是线程安全的; 未命中时在锁外做密钥扩展, 不阻塞其他线程的查找.
+//
+// 用法: SM4KeyCache cache(4096);
+//       auto key = cache.get(sessionId, keyBytes);  // 命中时keyBytes不会被读取
+//       sm4_ctr_crypt(*key, ...);
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "sm4.h"
+
+class SM4KeyCache {
+public:
+    typedef std::shared_ptr<const SM4Key> KeyPtr;
+
+    explicit SM4KeyCache(size_t capacity) : cap(capacity ? capacity : 1), hitCount(0), missCount(0) {}
+
+    SM4KeyCache(const SM4KeyCache&) = delete;
+    SM4KeyCache& operator=(const SM4KeyCache&) = delete;
+
+    // 查找keyId, 命中时把它移到最近使用的一端; 未命中返回空指针
+    KeyPtr find(uint64_t keyId) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(keyId);
+        if (it == index.end()) {
+            ++missCount;
+            return KeyPtr();
+        }
+        ++hitCount;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+
+    // 扩展key并以keyId存入(已存在时替换, 用于密钥轮换)
+    KeyPtr insert(uint64_t keyId, const uint8_t key[16]) {
+        KeyPtr expanded = expand(key);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(keyId);
+        if (it != index.end()) {
+            it->second->second = expanded;
+            lru.splice(lru.begin(), lru, it->second);
+            return expanded;
+        }
+        store(keyId, expanded);
+        return expanded;
+    }
+
+    // 命中直接返回; 未命中时扩展key后存入. 两个线程同时未命中时以先存入的为准
+    KeyPtr get(uint64_t keyId, const uint8_t key[16]) {
+        KeyPtr cached = find(keyId);
+        if (cached) return cached;
+
+        KeyPtr expanded = expand(key);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(keyId);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+        }
+        store(keyId, expanded);
+        return expanded;
+    }
+
+    // 撤销密钥; 已取出的副本在最后一个引用释放后清零
+    void erase(uint64_t keyId) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(keyId);
+        if (it == index.end()) return;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        lru.clear();
+        index.clear();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lru.size();
+    }
+
+    size_t capacity() const { return cap; }
+
+    uint64_t hits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hitCount;
+    }
+
+    uint64_t misses() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return missCount;
+    }
+
+private:
+    typedef std::list<std::pair<uint64_t, KeyPtr>> List;
+
+    const size_t cap;
+    mutable std::mutex mutex;
+    List lru;  // 表头为最近使用
+    std::unordered_map<uint64_t, List::iterator> index;
+    uint64_t hitCount, missCount;
+
+    static KeyPtr expand(const uint8_t key[16]) {
+        return KeyPtr(new SM4Key(key), [](const SM4Key* k) {
+            volatile uint32_t* p = const_cast<volatile uint32_t*>(k->enc);
+            for (int i = 0; i < 32; ++i) p[i] = 0;
+            p = const_cast<volatile uint32_t*>(k->dec);
+            for (int i = 0; i < 32; ++i) p[i] = 0;
+            delete k;
+        });
+    }
+
+    // 调用者已持有锁
+    void store(uint64_t keyId, const KeyPtr& key) {
+        lru.emplace_front(keyId, key);
+        index[keyId] = lru.begin();
+        if (lru.size() > cap) {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+};
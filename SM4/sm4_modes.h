@@ -0,0 +1,378 @@
+#pragma once
+
+// SM4工作模式的字节流接口: ECB / CBC / CFB / OFB / CTR / XTS, 面向磁盘和隧道加密的大块数据.
+//
+// 可并行的方向(ECB、CBC解密、CFB解密、CTR、XTS)每次取最多16个互相独立的分组一起送进多分组内核:
+//   有GFNI/AES-NI时用sm4_ct的常数时间实现(每批8或16个分组);
+//   否则用T表实现, 4个分组交错计算以掩盖查表和轮间依赖的延迟.
+// CBC加密、CFB加密和OFB的分组之间有依赖, 只能逐个分组串行计算: 有GFNI/AES-NI时用sm4_ct的常数时间
+// 单分组内核, 否则用T表. XTS的调整值和密文挪用、CTR的尾部分组也走这条路.
+// 热循环里没有I/O和堆分配, 临时数据都在栈上的256字节缓冲区里.
+//
+// 密钥均为扩展好的SM4Key; 各内核只接受按使用顺序排列的轮密钥(key.enc或key.dec), 不区分加解密.
+// ECB和CBC要求长度为16的倍数(不做填充, 否则返回false); CFB/OFB/CTR支持任意长度,
+// 并通过iv和num在多次调用间接续(num为当前分组里已用掉的密钥流字节数, 首次调用前置0);
+// XTS按IEEE P1619, 长度不是16的倍数时用密文挪用(ciphertext stealing), 至少要有一个整组.
+// 所有接口的in和out可以是同一缓冲区.
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "sm4.h"
+#include "sm4_ct.h"
+
+namespace sm4_modes {
+
+static const size_t BLOCK = 16;
+static const size_t CHUNK_BLOCKS = 16;  // 每批最多的分组数, 与最宽的AVX-512内核一致
+
+static inline uint64_t load_le64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline void store_le64(uint8_t* p, uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    std::memcpy(p, &v, 8);
+}
+
+static inline uint64_t load_be64(const uint8_t* p) {
+    return __builtin_bswap64(load_le64(p));
+}
+
+static inline void store_be64(uint8_t* p, uint64_t v) {
+    store_le64(p, __builtin_bswap64(v));
+}
+
+// out = a ^ b, 按8字节一次处理; 三者可以重叠为同一地址
+static inline void xor_bytes(uint8_t* out, const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        x ^= y;
+        std::memcpy(out + i, &x, 8);
+    }
+    for (; i < len; ++i) out[i] = a[i] ^ b[i];
+}
+
+static inline sm4_ct::Backend backend() {
+    static const sm4_ct::Backend detected = sm4_ct::detect_backend();
+    return detected;
+}
+
+// 单个分组, 用于有链式依赖的模式. 只有在没有GFNI/AES-NI的CPU上才回退到按秘密下标查表的T表实现
+static inline void crypt_block(const uint32_t rk[32], const uint8_t in[16], uint8_t out[16]) {
+    if (backend() != sm4_ct::BITSLICE) {
+        sm4_ct::crypt_block(backend(), in, out, rk);
+        return;
+    }
+    uint32_t x[4], y[4];
+    for (int w = 0; w < 4; ++w) x[w] = LoadBE32(in + w * 4);
+    SM4CryptRounds(x, y, rk);
+    for (int w = 0; w < 4; ++w) StoreBE32(out + w * 4, y[w]);
+}
+
+// 4个分组交错的T表实现: 四条互不依赖的轮函数链并排执行, 乱序核可以同时发出它们的查表
+static inline void crypt4_table(const uint8_t* in, uint8_t* out, const uint32_t rk[32]) {
+    uint32_t X0[4], X1[4], X2[4], X3[4];
+    for (int l = 0; l < 4; ++l) {
+        X0[l] = LoadBE32(in + l * 16);
+        X1[l] = LoadBE32(in + l * 16 + 4);
+        X2[l] = LoadBE32(in + l * 16 + 8);
+        X3[l] = LoadBE32(in + l * 16 + 12);
+    }
+#define SM4_MODES_ROUND4(i, A, B, C, D)                                   \
+    do {                                                                  \
+        uint32_t key = rk[i];                                             \
+        _Pragma("GCC unroll 4") for (int l = 0; l < 4; ++l) {             \
+            A[l] ^= TTable(B[l] ^ C[l] ^ D[l] ^ key);                     \
+        }                                                                 \
+    } while (0)
+
+    for (int i = 0; i < 32; i += 4) {
+        SM4_MODES_ROUND4(i, X0, X1, X2, X3);
+        SM4_MODES_ROUND4(i + 1, X1, X2, X3, X0);
+        SM4_MODES_ROUND4(i + 2, X2, X3, X0, X1);
+        SM4_MODES_ROUND4(i + 3, X3, X0, X1, X2);
+    }
+#undef SM4_MODES_ROUND4
+
+    for (int l = 0; l < 4; ++l) {
+        StoreBE32(out + l * 16, X3[l]);
+        StoreBE32(out + l * 16 + 4, X2[l]);
+        StoreBE32(out + l * 16 + 8, X1[l]);
+        StoreBE32(out + l * 16 + 12, X0[l]);
+    }
+}
+
+// 多分组内核: n个互相独立的分组, in/out可以相同
+inline void crypt_blocks(const uint8_t* in, uint8_t* out, size_t n, const uint32_t rk[32]) {
+    if (backend() != sm4_ct::BITSLICE) {
+        sm4_ct::crypt_blocks(in, out, n, rk, backend());
+        return;
+    }
+    for (; n >= 4; n -= 4, in += 64, out += 64) crypt4_table(in, out, rk);
+    for (; n > 0; --n, in += 16, out += 16) crypt_block(rk, in, out);
+}
+
+// XTS的调整值乘以α: 把16字节看作小端的128位整数左移一位, 溢出时异或0x87
+static inline void xts_mul_alpha(uint64_t& lo, uint64_t& hi) {
+    uint64_t carry = hi >> 63;
+    hi = (hi << 1) | (lo >> 63);
+    lo = (lo << 1) ^ (0x87 & (0 - carry));
+}
+
+// 一个分组的XTS变换: out = E/D(in ^ T) ^ T
+static inline void xts_block(const uint32_t rk[32], uint64_t lo, uint64_t hi, const uint8_t in[16], uint8_t out[16]) {
+    uint8_t t[16], buf[16];
+    store_le64(t, lo);
+    store_le64(t + 8, hi);
+    xor_bytes(buf, in, t, 16);
+    crypt_block(rk, buf, buf);
+    xor_bytes(out, buf, t, 16);
+}
+
+inline bool xts(const SM4Key& dataKey, const SM4Key& tweakKey, const uint8_t tweak[16],
+                const uint8_t* in, uint8_t* out, size_t len, bool encrypt) {
+    if (len < BLOCK) return false;
+    const uint32_t* rk = dataKey.rounds(encrypt);
+
+    uint8_t t0[16];
+    crypt_block(tweakKey.enc, tweak, t0);
+    uint64_t lo = load_le64(t0), hi = load_le64(t0 + 8);
+
+    // 有尾部时最后一个整组要和尾部一起做密文挪用, 不在批量循环里处理
+    size_t rest = len % BLOCK;
+    size_t bulk = len / BLOCK - (rest ? 1 : 0);
+
+    uint8_t tweaks[CHUNK_BLOCKS * 16], buf[CHUNK_BLOCKS * 16];
+    while (bulk > 0) {
+        size_t n = bulk < CHUNK_BLOCKS ? bulk : CHUNK_BLOCKS;
+        for (size_t i = 0; i < n; ++i) {
+            store_le64(tweaks + i * 16, lo);
+            store_le64(tweaks + i * 16 + 8, hi);
+            xts_mul_alpha(lo, hi);
+        }
+        xor_bytes(buf, in, tweaks, n * 16);
+        crypt_blocks(buf, buf, n, rk);
+        xor_bytes(out, buf, tweaks, n * 16);
+        in += n * 16;
+        out += n * 16;
+        bulk -= n;
+    }
+    if (rest == 0) return true;
+
+    // 密文挪用: 解密时最后一个整组要用下一个调整值, 顺序与加密相反
+    uint64_t lo2 = lo, hi2 = hi;
+    xts_mul_alpha(lo2, hi2);
+    uint8_t cc[16], tail[16];
+    std::memcpy(tail, in + 16, rest);
+    if (encrypt) {
+        xts_block(rk, lo, hi, in, cc);
+    } else {
+        xts_block(rk, lo2, hi2, in, cc);
+    }
+    uint8_t pp[16];
+    std::memcpy(pp, tail, rest);
+    std::memcpy(pp + rest, cc + rest, 16 - rest);
+    std::memcpy(out + 16, cc, rest);
+    if (encrypt) {
+        xts_block(rk, lo2, hi2, pp, out);
+    } else {
+        xts_block(rk, lo, hi, pp, out);
+    }
+    return true;
+}
+
+} // namespace sm4_modes
+
+// ---------------------------------------------------------------- ECB
+
+inline bool sm4_ecb_encrypt(const SM4Key& key, const uint8_t* in, uint8_t* out, size_t len) {
+    if (len % sm4_modes::BLOCK) return false;
+    sm4_modes::crypt_blocks(in, out, len / sm4_modes::BLOCK, key.enc);
+    return true;
+}
+
+inline bool sm4_ecb_decrypt(const SM4Key& key, const uint8_t* in, uint8_t* out, size_t len) {
+    if (len % sm4_modes::BLOCK) return false;
+    sm4_modes::crypt_blocks(in, out, len / sm4_modes::BLOCK, key.dec);
+    return true;
+}
+
+// ---------------------------------------------------------------- CBC
+// iv在返回时更新为最后一个密文分组, 可直接用于下一次调用
+
+inline bool sm4_cbc_encrypt(const SM4Key& key, uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) {
+    if (len % sm4_modes::BLOCK) return false;
+    for (; len > 0; len -= 16, in += 16, out += 16) {
+        sm4_modes::xor_bytes(iv, iv, in, 16);
+        sm4_modes::crypt_block(key.enc, iv, iv);
+        std::memcpy(out, iv, 16);
+    }
+    return true;
+}
+
+// 解密时各分组的分组密码运算互相独立, 整批解密后再与前一个密文分组异或
+inline bool sm4_cbc_decrypt(const SM4Key& key, uint8_t iv[16], const uint8_t* in, uint8_t* out, size_t len) {
+    using namespace sm4_modes;
+    if (len % BLOCK) return false;
+    uint8_t buf[CHUNK_BLOCKS * 16], last[16];
+    while (len > 0) {
+        size_t n = len / 16 < CHUNK_BLOCKS ? len / 16 : CHUNK_BLOCKS;
+        crypt_blocks(in, buf, n, key.dec);
+        std::memcpy(last, in + (n - 1) * 16, 16);
+        // 从后往前写, in与out相同时不会提前覆盖还要用的密文
+        for (size_t i = n - 1; i > 0; --i) {
+            xor_bytes(out + i * 16, buf + i * 16, in + (i - 1) * 16, 16);
+        }
+        xor_bytes(out, buf, iv, 16);
+        std::memcpy(iv, last, 16);
+        in += n * 16;
+        out += n * 16;
+        len -= n * 16;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- CFB (128位反馈)
+// iv中保存当前的密钥流分组; 加密后它逐字节被密文替换, 满一组时即为下一次的输入
+
+inline void sm4_cfb_encrypt(const SM4Key& key, uint8_t iv[16], unsigned* num,
+                            const uint8_t* in, uint8_t* out, size_t len) {
+    unsigned n = *num;
+    while (n && len) {
+        *out++ = iv[n] ^= *in++;
+        --len;
+        n = (n + 1) % 16;
+    }
+    for (; len >= 16; len -= 16, in += 16, out += 16) {
+        sm4_modes::crypt_block(key.enc, iv, iv);
+        sm4_modes::xor_bytes(iv, iv, in, 16);
+        std::memcpy(out, iv, 16);
+    }
+    if (len) {
+        sm4_modes::crypt_block(key.enc, iv, iv);
+        for (; n < len; ++n) out[n] = iv[n] ^= in[n];
+    }
+    *num = n;
+}
+
+inline void sm4_cfb_decrypt(const SM4Key& key, uint8_t iv[16], unsigned* num,
+                            const uint8_t* in, uint8_t* out, size_t len) {
+    using namespace sm4_modes;
+    unsigned n = *num;
+    while (n && len) {
+        uint8_t c = *in++;
+        *out++ = iv[n] ^ c;
+        iv[n] = c;
+        --len;
+        n = (n + 1) % 16;
+    }
+    // 第i组的密钥流是E(C[i-1]), 密文都已知, 可以整批计算
+    uint8_t buf[CHUNK_BLOCKS * 16], last[16];
+    while (len >= 16) {
+        size_t blocks = len / 16 < CHUNK_BLOCKS ? len / 16 : CHUNK_BLOCKS;
+        std::memcpy(buf, iv, 16);
+        std::memcpy(buf + 16, in, (blocks - 1) * 16);
+        std::memcpy(last, in + (blocks - 1) * 16, 16);
+        crypt_blocks(buf, buf, blocks, key.enc);
+        xor_bytes(out, in, buf, blocks * 16);
+        std::memcpy(iv, last, 16);
+        in += blocks * 16;
+        out += blocks * 16;
+        len -= blocks * 16;
+    }
+    if (len) {
+        crypt_block(key.enc, iv, iv);
+        for (; n < len; ++n) {
+            uint8_t c = in[n];
+            out[n] = iv[n] ^ c;
+            iv[n] = c;
+        }
+    }
+    *num = n;
+}
+
+// ---------------------------------------------------------------- OFB
+// 密钥流只依赖iv, 加密解密是同一个操作
+
+inline void sm4_ofb_crypt(const SM4Key& key, uint8_t iv[16], unsigned* num,
+                          const uint8_t* in, uint8_t* out, size_t len) {
+    unsigned n = *num;
+    while (n && len) {
+        *out++ = *in++ ^ iv[n];
+        --len;
+        n = (n + 1) % 16;
+    }
+    for (; len >= 16; len -= 16, in += 16, out += 16) {
+        sm4_modes::crypt_block(key.enc, iv, iv);
+        sm4_modes::xor_bytes(out, in, iv, 16);
+    }
+    if (len) {
+        sm4_modes::crypt_block(key.enc, iv, iv);
+        for (; n < len; ++n) out[n] = in[n] ^ iv[n];
+    }
+    *num = n;
+}
+
+// ---------------------------------------------------------------- CTR
+// ctr为128位大端计数器, 每用一个分组加1; ks保存最后一个未用完的密钥流分组, 与num一起用于接续
+
+inline void sm4_ctr_crypt(const SM4Key& key, uint8_t ctr[16], uint8_t ks[16], unsigned* num,
+                          const uint8_t* in, uint8_t* out, size_t len) {
+    using namespace sm4_modes;
+    unsigned n = *num;
+    while (n && len) {
+        *out++ = *in++ ^ ks[n];
+        --len;
+        n = (n + 1) % 16;
+    }
+
+    uint64_t hi = load_be64(ctr), lo = load_be64(ctr + 8);
+    uint8_t buf[CHUNK_BLOCKS * 16];
+    while (len > 0) {
+        size_t blocks = (len + 15) / 16;
+        if (blocks > CHUNK_BLOCKS) blocks = CHUNK_BLOCKS;
+        for (size_t i = 0; i < blocks; ++i) {
+            store_be64(buf + i * 16, hi);
+            store_be64(buf + i * 16 + 8, lo);
+            hi += (++lo == 0);
+        }
+        crypt_blocks(buf, buf, blocks, key.enc);
+        size_t bytes = blocks * 16 <= len ? blocks * 16 : len;
+        xor_bytes(out, in, buf, bytes);
+        if (bytes < blocks * 16) {
+            // 最后一个分组只用了一部分, 剩下的留给下一次调用
+            n = (unsigned)(bytes % 16);
+            std::memcpy(ks, buf + (blocks - 1) * 16, 16);
+        }
+        in += bytes;
+        out += bytes;
+        len -= bytes;
+    }
+    store_be64(ctr, hi);
+    store_be64(ctr + 8, lo);
+    *num = n;
+}
+
+// ---------------------------------------------------------------- XTS
+// dataKey为数据密钥, tweakKey为调整值密钥, tweak通常是扇区号(小端)
+
+inline bool sm4_xts_encrypt(const SM4Key& dataKey, const SM4Key& tweakKey, const uint8_t tweak[16],
+                            const uint8_t* in, uint8_t* out, size_t len) {
+    return sm4_modes::xts(dataKey, tweakKey, tweak, in, out, len, true);
+}
+
+inline bool sm4_xts_decrypt(const SM4Key& dataKey, const SM4Key& tweakKey, const uint8_t tweak[16],
+                            const uint8_t* in, uint8_t* out, size_t len) {
+    return sm4_modes::xts(dataKey, tweakKey, tweak, in, out, len, false);
+}
@@ -0,0 +1,264 @@
+// sm4file: 多线程SM4-CTR / SM4-XTS文件加解密工具.
+//
+// 编译: g++ -O2 -pthread sm4file.cpp -o sm4file
+// 用法: sm4file [-m ctr|xts] [-d] -k 密钥 [-i IV] [-s 扇区大小] [-j 线程数] [-q] 输入文件 输出文件
+//   -m ctr  默认. 密钥32个十六进制字符, IV为128位初始计数器(32个十六进制字符, 默认全零); 加解密相同
+//   -m xts  密钥64个十六进制字符(数据密钥 + 调整值密钥), 每个扇区独立加密, 调整值为扇区号(小端),
+//           -i 给出时作为第0个扇区号的起始值; -d 为解密. 文件末尾不满一个扇区时用密文挪用, 但至少要16字节
+//   -s N    XTS扇区大小, 默认4096
+//   -j N    并发线程数, 默认为CPU核数
+//   -q      不输出吞吐量
+//
+// 文件按4MB(XTS时取扇区大小的整数倍)切成互相独立的段: CTR的第k段从计数器 IV + 段偏移/16 开始,
+// XTS的扇区号由段偏移直接算出, 因此各段可以任意顺序并行处理, 结果与单线程逐字节一致.
+// 输入mmap后直接作为加密的源数据, 每个线程把结果写进自己的对齐缓冲区, 再pwrite到输出文件的对应偏移,
+// 中间没有额外拷贝. 吞吐量输出到stderr.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sm4_modes.h"
+
+static const size_t SEGMENT = 4 << 20;
+static const size_t BUFFER_ALIGN = 4096;
+
+struct Options {
+    bool xts = false;
+    bool decrypt = false;
+    bool quiet = false;
+    unsigned threads = 0;
+    size_t sector = 4096;
+    uint8_t key[32];
+    uint8_t iv[16] = {0};
+};
+
+struct Job {
+    const uint8_t* in;
+    int outFd;
+    uint64_t size;
+    size_t segment;
+    SM4Key dataKey, tweakKey;
+    const Options* opt;
+    std::atomic<uint64_t> next;
+    std::atomic<bool> failed;
+    std::string error;
+};
+
+static bool parseHex(const char* hex, uint8_t* out, size_t len) {
+    if (strlen(hex) != len * 2) return false;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned v;
+        if (sscanf(hex + 2 * i, "%2x", &v) != 1) return false;
+        out[i] = (uint8_t)v;
+    }
+    return true;
+}
+
+// 128位大端计数器加上n
+static void addCounter(uint8_t ctr[16], uint64_t n) {
+    uint64_t lo = sm4_modes::load_be64(ctr + 8);
+    uint64_t hi = sm4_modes::load_be64(ctr);
+    uint64_t sum = lo + n;
+    hi += sum < lo;
+    sm4_modes::store_be64(ctr, hi);
+    sm4_modes::store_be64(ctr + 8, sum);
+}
+
+// 128位小端扇区号加上n
+static void addTweak(uint8_t tweak[16], uint64_t n) {
+    uint64_t lo = sm4_modes::load_le64(tweak);
+    uint64_t hi = sm4_modes::load_le64(tweak + 8);
+    uint64_t sum = lo + n;
+    hi += sum < lo;
+    sm4_modes::store_le64(tweak, sum);
+    sm4_modes::store_le64(tweak + 8, hi);
+}
+
+static bool writeAll(int fd, const uint8_t* buf, size_t len, uint64_t offset, std::string& error) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, buf, len, (off_t)offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = std::string("pwrite: ") + strerror(errno);
+            return false;
+        }
+        buf += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return true;
+}
+
+static bool cryptSegment(Job& job, uint64_t offset, size_t len, uint8_t* buf, std::string& error) {
+    const Options& opt = *job.opt;
+    const uint8_t* src = job.in + offset;
+    if (!opt.xts) {
+        uint8_t ctr[16], ks[16];
+        unsigned num = 0;
+        std::memcpy(ctr, opt.iv, 16);
+        addCounter(ctr, offset / 16);
+        sm4_ctr_crypt(job.dataKey, ctr, ks, &num, src, buf, len);
+    } else {
+        for (size_t pos = 0; pos < len; pos += opt.sector) {
+            size_t n = std::min(opt.sector, len - pos);
+            uint8_t tweak[16];
+            std::memcpy(tweak, opt.iv, 16);
+            addTweak(tweak, (offset + pos) / opt.sector);
+            bool ok = opt.decrypt ? sm4_xts_decrypt(job.dataKey, job.tweakKey, tweak, src + pos, buf + pos, n)
+                                  : sm4_xts_encrypt(job.dataKey, job.tweakKey, tweak, src + pos, buf + pos, n);
+            if (!ok) {
+                error = "XTS: 最后一个扇区不足16字节";
+                return false;
+            }
+        }
+    }
+    return writeAll(job.outFd, buf, len, offset, error);
+}
+
+static void worker(Job& job) {
+    void* buf = nullptr;
+    if (posix_memalign(&buf, BUFFER_ALIGN, job.segment) != 0) {
+        if (!job.failed.exchange(true)) job.error = "out of memory";
+        return;
+    }
+    uint64_t segments = (job.size + job.segment - 1) / job.segment;
+    std::string error;
+    for (uint64_t i = job.next++; i < segments && !job.failed; i = job.next++) {
+        uint64_t offset = i * job.segment;
+        size_t len = (size_t)std::min<uint64_t>(job.segment, job.size - offset);
+        if (!cryptSegment(job, offset, len, static_cast<uint8_t*>(buf), error)) {
+            if (!job.failed.exchange(true)) job.error = error;
+            break;
+        }
+    }
+    free(buf);
+}
+
+static void usage() {
+    fprintf(stderr, "用法: sm4file [-m ctr|xts] [-d] -k 密钥 [-i IV] [-s 扇区大小] [-j 线程数] [-q] 输入文件 输出文件\n");
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    const char* keyHex = nullptr;
+    const char* ivHex = nullptr;
+    int c;
+    while ((c = getopt(argc, argv, "m:dk:i:s:j:qh")) != -1) {
+        switch (c) {
+        case 'm':
+            if (strcmp(optarg, "xts") == 0) {
+                opt.xts = true;
+            } else if (strcmp(optarg, "ctr") != 0) {
+                usage();
+                return 2;
+            }
+            break;
+        case 'd': opt.decrypt = true; break;
+        case 'k': keyHex = optarg; break;
+        case 'i': ivHex = optarg; break;
+        case 's': opt.sector = (size_t)strtoul(optarg, nullptr, 10); break;
+        case 'j': opt.threads = (unsigned)atoi(optarg); break;
+        case 'q': opt.quiet = true; break;
+        default: usage(); return 2;
+        }
+    }
+    if (optind + 2 != argc || !keyHex) {
+        usage();
+        return 2;
+    }
+    if (!parseHex(keyHex, opt.key, opt.xts ? 32 : 16)) {
+        fprintf(stderr, "sm4file: 密钥应为%d个十六进制字符\n", opt.xts ? 64 : 32);
+        return 2;
+    }
+    if (ivHex && !parseHex(ivHex, opt.iv, 16)) {
+        fprintf(stderr, "sm4file: IV应为32个十六进制字符\n");
+        return 2;
+    }
+    if (opt.xts && (opt.sector < 16 || opt.sector > SEGMENT)) {
+        fprintf(stderr, "sm4file: 扇区大小应在16到%zu之间\n", SEGMENT);
+        return 2;
+    }
+    const char* inPath = argv[optind];
+    const char* outPath = argv[optind + 1];
+
+    int inFd = open(inPath, O_RDONLY);
+    if (inFd < 0) {
+        fprintf(stderr, "sm4file: %s: %s\n", inPath, strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (fstat(inFd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        fprintf(stderr, "sm4file: %s: 不是普通文件\n", inPath);
+        close(inFd);
+        return 1;
+    }
+    int outFd = open(outPath, O_WRONLY | O_CREAT, 0644);
+    if (outFd < 0 || ftruncate(outFd, st.st_size) != 0) {
+        fprintf(stderr, "sm4file: %s: %s\n", outPath, strerror(errno));
+        close(inFd);
+        return 1;
+    }
+
+    Job job;
+    job.size = (uint64_t)st.st_size;
+    job.outFd = outFd;
+    job.opt = &opt;
+    job.dataKey.set(opt.key);
+    if (opt.xts) job.tweakKey.set(opt.key + 16);
+    job.segment = opt.xts ? SEGMENT / opt.sector * opt.sector : SEGMENT;
+    job.next = 0;
+    job.failed = false;
+    job.in = nullptr;
+
+    void* map = nullptr;
+    if (job.size > 0) {
+        map = mmap(nullptr, job.size, PROT_READ, MAP_PRIVATE, inFd, 0);
+        if (map == MAP_FAILED) {
+            fprintf(stderr, "sm4file: mmap: %s\n", strerror(errno));
+            close(inFd);
+            close(outFd);
+            return 1;
+        }
+        madvise(map, job.size, MADV_SEQUENTIAL);
+        madvise(map, job.size, MADV_WILLNEED);
+        job.in = static_cast<const uint8_t*>(map);
+    }
+
+    uint64_t segments = (job.size + job.segment - 1) / job.segment;
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::max<uint64_t>(1, std::min<uint64_t>(threads, segments));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker, std::ref(job));
+    worker(job);
+    for (auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (map) munmap(map, job.size);
+    close(inFd);
+    int status = 0;
+    if (close(outFd) != 0 && !job.failed) {
+        job.failed = true;
+        job.error = std::string("close: ") + strerror(errno);
+    }
+    if (job.failed) {
+        fprintf(stderr, "sm4file: %s: %s\n", outPath, job.error.c_str());
+        status = 1;
+    } else if (!opt.quiet) {
+        fprintf(stderr, "%s: %llu 字节, %u 线程, %.1f MB/s\n", inPath, (unsigned long long)job.size, threads,
+                seconds > 0 ? job.size / seconds / 1e6 : 0.0);
+    }
+    return status;
+}
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <sys/uio.h>
+
+// S盒
+inline const uint8_t S0[256] = {
+    0x3E,0x72,0x5B,0x47,0xCA,0xE0,0x00,0x33,0x04,0xD1,0x54,0x98,0x09,0xB9,0x6D,0xCB,
+    0x7B,0x1B,0xF9,0x32,0xAF,0x9D,0x6A,0xA5,0xB8,0x2D,0xFC,0x1D,0x08,0x53,0x03,0x90,
+    0x4D,0x4E,0x84,0x99,0xE4,0xCE,0xD9,0x91,0xDD,0xB6,0x85,0x48,0x8B,0x29,0x6E,0xAC,
+    0xCD,0xC1,0xF8,0x1E,0x73,0x43,0x69,0xC6,0xB5,0xBD,0xFD,0x39,0x63,0x20,0xD4,0x38,
+    0x76,0x7D,0xB2,0xA7,0xCF,0xED,0x57,0xC5,0xF3,0x2C,0xBB,0x14,0x21,0x06,0x55,0x9B,
+    0xE3,0xEF,0x5E,0x31,0x4F,0x7F,0x5A,0xA4,0x0D,0x82,0x51,0x49,0x5F,0xBA,0x58,0x1C,
+    0x4A,0x16,0xD5,0x17,0xA8,0x92,0x24,0x1F,0x8C,0xFF,0xD8,0xAE,0x2E,0x01,0xD3,0xAD,
+    0x3B,0x4B,0xDA,0x46,0xEB,0xC9,0xDE,0x9A,0x8F,0x87,0xD7,0x3A,0x80,0x6F,0x2F,0xC8,
+    0xB1,0xB4,0x37,0xF7,0x0A,0x22,0x13,0x28,0x7C,0xCC,0x3C,0x89,0xC7,0xC3,0x96,0x56,
+    0x07,0xBF,0x7E,0xF0,0x0B,0x2B,0x97,0x52,0x35,0x41,0x79,0x61,0xA6,0x4C,0x10,0xFE,
+    0xBC,0x26,0x95,0x88,0x8A,0xB0,0xA3,0xFB,0xC0,0x18,0x94,0xF2,0xE1,0xE5,0xE9,0x5D,
+    0xD0,0xDC,0x11,0x66,0x64,0x5C,0xEC,0x59,0x42,0x75,0x12,0xF5,0x74,0x9C,0xAA,0x23,
+    0x0E,0x86,0xAB,0xBE,0x2A,0x02,0xE7,0x67,0xE6,0x44,0xA2,0x6C,0xC2,0x93,0x9F,0xF1,
+    0xF6,0xFA,0x36,0xD2,0x50,0x68,0x9E,0x62,0x71,0x15,0x3D,0xD6,0x40,0xC4,0xE2,0x0F,
+    0x8E,0x83,0x77,0x6B,0x25,0x05,0x3F,0x0C,0x30,0xEA,0x70,0xB7,0xA1,0xE8,0xA9,0x65,
+    0x8D,0x27,0x1A,0xDB,0x81,0xB3,0xA0,0xF4,0x45,0x7A,0x19,0xDF,0xEE,0x78,0x34,0x60
+};
+
+inline const uint8_t S1[256] = {
+    0x55,0xC2,0x63,0x71,0x3B,0xC8,0x47,0x86,0x9F,0x3C,0xDA,0x5B,0x29,0xAA,0xFD,0x77,
+    0x8C,0xC5,0x94,0x0C,0xA6,0x1A,0x13,0x00,0xE3,0xA8,0x16,0x72,0x40,0xF9,0xF8,0x42,
+    0x44,0x26,0x68,0x96,0x81,0xD9,0x45,0x3E,0x10,0x76,0xC6,0xA7,0x8B,0x39,0x43,0xE1,
+    0x3A,0xB5,0x56,0x2A,0xC0,0x6D,0xB3,0x05,0x22,0x66,0xBF,0xDC,0x0B,0xFA,0x62,0x48,
+    0xDD,0x20,0x11,0x06,0x36,0xC9,0xC1,0xCF,0xF6,0x27,0x52,0xBB,0x69,0xF5,0xD4,0x87,
+    0x7F,0x84,0x4C,0xD2,0x9C,0x57,0xA4,0xBC,0x4F,0x9A,0xDF,0xFE,0xD6,0x8D,0x7A,0xEB,
+    0x2B,0x53,0xD8,0x5C,0xA1,0x14,0x17,0xFB,0x23,0xD5,0x7D,0x30,0x67,0x73,0x08,0x09,
+    0xEE,0xB7,0x70,0x3F,0x61,0xB2,0x19,0x8E,0x4E,0xE5,0x4B,0x93,0x8F,0x5D,0xDB,0xA9,
+    0xAD,0xF1,0xAE,0x2E,0xCB,0x0D,0xFC,0xF4,0x2D,0x46,0x6E,0x1D,0x97,0xE8,0xD1,0xE9,
+    0x4D,0x37,0xA5,0x75,0x5E,0x83,0x9E,0xAB,0x82,0x9D,0xB9,0x1C,0xE0,0xCD,0x49,0x89,
+    0x01,0xB6,0xBD,0x58,0x24,0xA2,0x5F,0x38,0x78,0x99,0x15,0x90,0x50,0xB8,0x95,0xE4,
+    0xD0,0x91,0xC7,0xCE,0xED,0x0F,0xB4,0x6F,0xA0,0xCC,0xF0,0x02,0x4A,0x79,0xC3,0xDE,
+    0xA3,0xEF,0xEA,0x51,0xE6,0x6B,0x18,0xEC,0x1B,0x2C,0x80,0xF7,0x74,0xE7,0xFF,0x21,
+    0x5A,0x6A,0x54,0x1E,0x41,0x31,0x92,0x35,0xC4,0x33,0x07,0x0A,0xBA,0x7E,0x0E,0x34,
+    0x88,0xB1,0x98,0x7C,0xF3,0x3D,0x60,0x6C,0x7B,0xCA,0xD3,0x1F,0x32,0x65,0x04,0x28,
+    0x64,0xBE,0x85,0x9B,0x2F,0x59,0x8A,0xD7,0xB0,0x25,0xAC,0xAF,0x12,0x03,0xE2,0xF2
+};
+
+inline const uint16_t D[16] = {
+    0x44D7,0x26BC,0x626B,0x135E,0x5789,0x35E2,0x7135,0x09AF,
+    0x4D78,0x2F13,0x6BC4,0x1AF1,0x5E26,0x3C4D,0x789A,0x47AC
+};
+
+#define LFSR_SIZE 16
+
+// 31位加法
+inline uint32_t addition_uint31(uint32_t a, uint32_t b) {
+    uint32_t c = a + b;
+    return (c & 0x7FFFFFFF) + (c >> 31);
+}
+
+// 31位循环左移
+inline uint32_t rotl_uint31(uint32_t a, int shift) {
+    return ((a << shift) | (a >> (31 - shift))) & 0x7FFFFFFF;
+}
+
+// 32位循环左移
+inline uint32_t rotl_uint32(uint32_t a, int shift) {
+    return ((a << shift) | (a >> (32 - shift))) & 0xFFFFFFFF;
+}
+
+// 线性变换
+inline uint32_t L1(uint32_t x) {
+    return x ^ rotl_uint32(x, 2) ^ rotl_uint32(x, 10) ^ rotl_uint32(x, 18) ^ rotl_uint32(x, 24);
+}
+inline uint32_t L2(uint32_t x) {
+    return x ^ rotl_uint32(x, 8) ^ rotl_uint32(x, 14) ^ rotl_uint32(x, 22) ^ rotl_uint32(x, 30);
+}
+
+// 合成32位
+inline uint32_t make_uint32(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    return ((uint32_t)a << 24) | ((uint32_t)b << 16) | ((uint32_t)c << 8) | d;
+}
+
+// 合成31位
+inline uint32_t make_uint31(uint8_t a, uint16_t b, uint8_t c) {
+    return (((uint32_t)a << 23) & 0x7FFFFFFF) | (((uint32_t)b << 8) & 0x7FFFFF00) | (c & 0xFF);
+}
+
+// ZUC上下文
+// LFSR是环形缓冲区: 逻辑上的s_i存放在lfsr[(head + i) % 16], 每个时钟只把新的s16写到s0的位置并把head加1,
+// 不再搬动其余15个字
+struct ZUC_CTX {
+    uint32_t lfsr[LFSR_SIZE];
+    uint32_t r1, r2;
+    uint32_t x[4];
+    unsigned head;
+};
+
+// 逻辑位置i处的LFSR单元
+inline uint32_t &lfsr_at(ZUC_CTX &ctx, unsigned i) { return ctx.lfsr[(ctx.head + i) & (LFSR_SIZE - 1)]; }
+inline uint32_t lfsr_at(const ZUC_CTX &ctx, unsigned i) { return ctx.lfsr[(ctx.head + i) & (LFSR_SIZE - 1)]; }
+
+// 比特重组; P为编译期已知的head, 此时所有下标都是常量
+template<unsigned P>
+inline void bit_reorganization_at(ZUC_CTX &ctx) {
+    const uint32_t *s = ctx.lfsr;
+    ctx.x[0] = ((s[(P + 15) & 15] & 0x7FFF8000) << 1) | (s[(P + 14) & 15] & 0xFFFF);
+    ctx.x[1] = ((s[(P + 11) & 15] & 0xFFFF) << 16) | (s[(P + 9) & 15] >> 15);
+    ctx.x[2] = ((s[(P + 7) & 15] & 0xFFFF) << 16) | (s[(P + 5) & 15] >> 15);
+    ctx.x[3] = ((s[(P + 2) & 15] & 0xFFFF) << 16) | (s[P & 15] >> 15);
+}
+
+// LFSR下一个状态
+template<unsigned P>
+inline uint32_t lfsr_next_at(const ZUC_CTX &ctx) {
+    const uint32_t *s = ctx.lfsr;
+    uint32_t f = s[P & 15];
+    f = addition_uint31(f, rotl_uint31(s[P & 15], 8));
+    f = addition_uint31(f, rotl_uint31(s[(P + 4) & 15], 20));
+    f = addition_uint31(f, rotl_uint31(s[(P + 10) & 15], 21));
+    f = addition_uint31(f, rotl_uint31(s[(P + 13) & 15], 17));
+    f = addition_uint31(f, rotl_uint31(s[(P + 15) & 15], 15));
+    return f;
+}
+
+// 运行时head的版本, 用于不满16个时钟的零头
+inline void bit_reorganization(ZUC_CTX &ctx) {
+    ctx.x[0] = ((lfsr_at(ctx, 15) & 0x7FFF8000) << 1) | (lfsr_at(ctx, 14) & 0xFFFF);
+    ctx.x[1] = ((lfsr_at(ctx, 11) & 0xFFFF) << 16) | (lfsr_at(ctx, 9) >> 15);
+    ctx.x[2] = ((lfsr_at(ctx, 7) & 0xFFFF) << 16) | (lfsr_at(ctx, 5) >> 15);
+    ctx.x[3] = ((lfsr_at(ctx, 2) & 0xFFFF) << 16) | (lfsr_at(ctx, 0) >> 15);
+}
+
+inline uint32_t lfsr_next(const ZUC_CTX &ctx) {
+    uint32_t f = lfsr_at(ctx, 0);
+    f = addition_uint31(f, rotl_uint31(lfsr_at(ctx, 0), 8));
+    f = addition_uint31(f, rotl_uint31(lfsr_at(ctx, 4), 20));
+    f = addition_uint31(f, rotl_uint31(lfsr_at(ctx, 10), 21));
+    f = addition_uint31(f, rotl_uint31(lfsr_at(ctx, 13), 17));
+    f = addition_uint31(f, rotl_uint31(lfsr_at(ctx, 15), 15));
+    return f;
+}
+
+// LFSR移位: 新的s16覆盖s0, head前进一格
+inline void lfsr_shift(ZUC_CTX &ctx) {
+    uint32_t f = lfsr_next(ctx);
+    lfsr_at(ctx, 0) = f;
+    ctx.head = (ctx.head + 1) & (LFSR_SIZE - 1);
+}
+
+// LFSR初始化
+inline void lfsr_init(ZUC_CTX &ctx, uint32_t u) {
+    uint32_t f = addition_uint31(lfsr_next(ctx), u);
+    lfsr_at(ctx, 0) = f;
+    ctx.head = (ctx.head + 1) & (LFSR_SIZE - 1);
+}
+
+// 把head转回0, 之后可以走下标全为常量的16时钟展开路径
+inline void lfsr_normalize(ZUC_CTX &ctx) {
+    if (ctx.head == 0) return;
+    uint32_t tmp[LFSR_SIZE];
+    for (unsigned i = 0; i < LFSR_SIZE; ++i) tmp[i] = lfsr_at(ctx, i);
+    std::memcpy(ctx.lfsr, tmp, sizeof(tmp));
+    ctx.head = 0;
+}
+
+// S盒变换
+inline uint32_t Sbox(uint32_t w) {
+    return ((uint32_t)S0[(w >> 24) & 0xFF] << 24) |
+           ((uint32_t)S1[(w >> 16) & 0xFF] << 16) |
+           ((uint32_t)S0[(w >> 8) & 0xFF] << 8) |
+           ((uint32_t)S1[w & 0xFF]);
+}
+
+// F函数
+inline uint32_t F(ZUC_CTX &ctx) {
+    uint32_t W = ((ctx.x[0] ^ ctx.r1) + ctx.r2) & 0xFFFFFFFF;
+    uint32_t W1 = (ctx.r1 + ctx.x[1]) & 0xFFFFFFFF;
+    uint32_t W2 = ctx.r2 ^ ctx.x[2];
+    uint32_t u = L1(((W1 & 0x0000FFFF) << 16) | (W2 >> 16));
+    uint32_t v = L2(((W2 & 0x0000FFFF) << 16) | (W1 >> 16));
+    ctx.r1 = Sbox(u);
+    ctx.r2 = Sbox(v);
+    return W;
+}
+
+// 相位为P的一个初始化时钟 / 工作时钟; 新的s16正好写在lfsr[P]
+template<unsigned P>
+inline void zuc_init_clock_at(ZUC_CTX &ctx) {
+    bit_reorganization_at<P>(ctx);
+    uint32_t w = F(ctx);
+    ctx.lfsr[P] = addition_uint31(lfsr_next_at<P>(ctx), w >> 1);
+}
+
+template<unsigned P>
+inline uint32_t zuc_keystream_at(ZUC_CTX &ctx) {
+    bit_reorganization_at<P>(ctx);
+    uint32_t z = F(ctx) ^ ctx.x[3];
+    ctx.lfsr[P] = lfsr_next_at<P>(ctx);
+    return z;
+}
+
+// 从head == 0开始连续16个时钟, 结束时head又回到0
+template<size_t... P>
+inline void zuc_init_rounds16(ZUC_CTX &ctx, std::index_sequence<P...>) {
+    (zuc_init_clock_at<P>(ctx), ...);
+}
+
+template<size_t... P>
+inline void zuc_keystream16(ZUC_CTX &ctx, uint32_t *keystream, std::index_sequence<P...>) {
+    ((keystream[P] = zuc_keystream_at<P>(ctx)), ...);
+}
+
+// ZUC-256的装载常数: 第0行用于加密, 第1~3行分别用于32/64/128位MAC
+inline const uint8_t ZUC256_D[4][16] = {
+    {0x22, 0x2F, 0x24, 0x2A, 0x6D, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+    {0x22, 0x2F, 0x25, 0x2A, 0x6D, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+    {0x23, 0x2F, 0x24, 0x2A, 0x6D, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+    {0x23, 0x2F, 0x25, 0x2A, 0x6D, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+};
+
+// 8 || 7 || 8 || 8 比特拼成31位
+inline uint32_t make_uint31_256(uint8_t a, uint8_t d, uint8_t b, uint8_t c) {
+    return ((uint32_t)a << 23) | ((uint32_t)(d & 0x7F) << 16) | ((uint32_t)b << 8) | c;
+}
+
+// 密钥装载: ZUC-128, s_i = k_i || d_i || iv_i
+inline void zuc_load_key(uint32_t lfsr[LFSR_SIZE], const uint8_t key[16], const uint8_t iv[16]) {
+    for (int i = 0; i < 16; ++i)
+        lfsr[i] = make_uint31(key[i], D[i], iv[i]);
+}
+
+// 密钥装载: ZUC-256, 32字节密钥, 25字节IV(iv[17..24]只用低6位).
+// tagBits为0时装载加密用的常数, 为32/64/128时装载对应长度MAC的常数
+inline void zuc256_load_key(uint32_t lfsr[LFSR_SIZE], const uint8_t key[32], const uint8_t iv[25], int tagBits = 0) {
+    const uint8_t *d = ZUC256_D[tagBits == 32 ? 1 : tagBits == 64 ? 2 : tagBits == 128 ? 3 : 0];
+    const uint8_t *k = key;
+    uint8_t v[25];
+    for (int i = 0; i < 25; ++i) v[i] = i < 17 ? iv[i] : (iv[i] & 0x3F);
+    lfsr[0] = make_uint31_256(k[0], d[0], k[21], k[16]);
+    lfsr[1] = make_uint31_256(k[1], d[1], k[22], k[17]);
+    lfsr[2] = make_uint31_256(k[2], d[2], k[23], k[18]);
+    lfsr[3] = make_uint31_256(k[3], d[3], k[24], k[19]);
+    lfsr[4] = make_uint31_256(k[4], d[4], k[25], k[20]);
+    lfsr[5] = make_uint31_256(v[0], d[5] | v[17], k[5], k[26]);
+    lfsr[6] = make_uint31_256(v[1], d[6] | v[18], k[6], k[27]);
+    lfsr[7] = make_uint31_256(v[10], d[7] | v[19], k[7], v[2]);
+    lfsr[8] = make_uint31_256(k[8], d[8] | v[20], v[3], v[11]);
+    lfsr[9] = make_uint31_256(k[9], d[9] | v[21], v[12], v[4]);
+    lfsr[10] = make_uint31_256(v[5], d[10] | v[22], k[10], k[28]);
+    lfsr[11] = make_uint31_256(k[11], d[11] | v[23], v[6], v[13]);
+    lfsr[12] = make_uint31_256(k[12], d[12] | v[24], v[7], v[14]);
+    lfsr[13] = make_uint31_256(k[13], d[13], v[15], v[8]);
+    lfsr[14] = make_uint31_256(k[14], d[14] | (k[31] >> 4), v[16], v[9]);
+    lfsr[15] = make_uint31_256(k[15], d[15] | (k[31] & 0x0F), k[30], k[29]);
+}
+
+// LFSR装载后的初始化, ZUC-128与ZUC-256相同
+inline void zuc_init_state(ZUC_CTX &ctx) {
+    ctx.r1 = ctx.r2 = 0;
+    ctx.head = 0;
+    // 32轮初始化 = 两个完整的16时钟周期
+    zuc_init_rounds16(ctx, std::make_index_sequence<16>());
+    zuc_init_rounds16(ctx, std::make_index_sequence<16>());
+    // 工作模式的第一次F输出丢弃, 之后每个时钟输出一个密钥字
+    bit_reorganization(ctx);
+    F(ctx);
+    lfsr_shift(ctx);
+}
+
+// 密钥装载与初始化
+inline void zuc_init(ZUC_CTX &ctx, const uint8_t key[16], const uint8_t iv[16]) {
+    zuc_load_key(ctx.lfsr, key, iv);
+    zuc_init_state(ctx);
+}
+
+// ZUC-256的初始化; 之后的密钥流生成、流式加密等与ZUC-128共用
+inline void zuc256_init(ZUC_CTX &ctx, const uint8_t key[32], const uint8_t iv[25], int tagBits = 0) {
+    zuc256_load_key(ctx.lfsr, key, iv, tagBits);
+    zuc_init_state(ctx);
+}
+
+// 生成密钥流; 可多次调用, 输出是连续的.
+// 整16个字的部分先把head转回0, 再走全展开的路径; 零头逐个时钟计算
+inline void zuc_generate_keystream(ZUC_CTX &ctx, uint32_t *keystream, int n) {
+    if (n >= 16) {
+        lfsr_normalize(ctx);
+        for (; n >= 16; n -= 16, keystream += 16)
+            zuc_keystream16(ctx, keystream, std::make_index_sequence<16>());
+    }
+    for (int i = 0; i < n; ++i) {
+        bit_reorganization(ctx);
+        keystream[i] = F(ctx) ^ ctx.x[3];
+        lfsr_shift(ctx);
+    }
+}
+
+// 每批生成的密钥字数; 栈上只占64字节, 与消息长度无关
+#define ZUC_BATCH_WORDS 16
+
+// 生成n个密钥字并按大端字节序写入out(4n字节)
+inline void zuc_keystream_bytes(ZUC_CTX &ctx, uint8_t *out, int n) {
+    uint32_t words[ZUC_BATCH_WORDS];
+    zuc_generate_keystream(ctx, words, n);
+    for (int i = 0; i < n; ++i) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        words[i] = __builtin_bswap32(words[i]);
+#else
+        words[i] = ((words[i] >> 24) & 0xFF) | ((words[i] >> 8) & 0xFF00) |
+                   ((words[i] << 8) & 0xFF0000) | (words[i] << 24);
+#endif
+    }
+    std::memcpy(out, words, 4 * (size_t)n);
+}
+
+// out = in ^ ks, 按64位字直接在调用者的缓冲区上异或(编译器会再向量化), in与out可以相同
+inline void zuc_xor_bytes(uint8_t *out, const uint8_t *in, const uint8_t *ks, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, in + i, 8);
+        std::memcpy(&b, ks + i, 8);
+        a ^= b;
+        std::memcpy(out + i, &a, 8);
+    }
+    for (; i < len; ++i) out[i] = in[i] ^ ks[i];
+}
+
+// 流式加解密的核心: rest[4]保存上次用剩的密钥流字节, *used为其中已用掉的字节数(4表示没有余量).
+// 先用完余量, 再每次生成16个字(64字节)整批异或, 最后一批只生成需要的字数, 没用完的字节留在rest里
+inline void zuc_crypt_stream(ZUC_CTX &ctx, uint8_t rest[4], unsigned *used,
+                             const uint8_t *input, uint8_t *output, size_t len) {
+    while (*used < 4 && len > 0) {
+        *output++ = *input++ ^ rest[(*used)++];
+        --len;
+    }
+    uint8_t ks[4 * ZUC_BATCH_WORDS];
+    while (len >= sizeof(ks)) {
+        zuc_keystream_bytes(ctx, ks, ZUC_BATCH_WORDS);
+        zuc_xor_bytes(output, input, ks, sizeof(ks));
+        input += sizeof(ks);
+        output += sizeof(ks);
+        len -= sizeof(ks);
+    }
+    if (len > 0) {
+        int words = (int)((len + 3) / 4);
+        zuc_keystream_bytes(ctx, ks, words);
+        zuc_xor_bytes(output, input, ks, len);
+        std::memcpy(rest, ks + 4 * (words - 1), 4);
+        *used = (unsigned)(len - 4 * (words - 1));
+    }
+}
+
+// 加解密; 每次调用从新的密钥字开始, 上次最后一个字里没用完的字节被丢弃.
+// 需要跨调用连续的字节流时用下面的ZUCCipher
+inline void zuc_encrypt(ZUC_CTX &ctx, const uint8_t *input, uint8_t *output, int len) {
+    uint8_t rest[4];
+    unsigned used = 4;
+    zuc_crypt_stream(ctx, rest, &used, input, output, len > 0 ? (size_t)len : 0);
+}
+
+// 分散/聚集加解密的分段遍历: 按输入与输出片段的交叠切成连续的小段依次处理
+inline bool zuc_crypt_iov(ZUC_CTX &ctx, uint8_t rest[4], unsigned *used, const struct iovec *src, size_t srcCount,
+                          const struct iovec *dst, size_t dstCount) {
+    size_t srcLen = 0, dstLen = 0;
+    for (size_t i = 0; i < srcCount; ++i) srcLen += src[i].iov_len;
+    for (size_t i = 0; i < dstCount; ++i) dstLen += dst[i].iov_len;
+    if (srcLen != dstLen) return false;
+
+    size_t si = 0, so = 0, di = 0, dof = 0;
+    while (srcLen > 0) {
+        while (so == src[si].iov_len) { ++si; so = 0; }
+        while (dof == dst[di].iov_len) { ++di; dof = 0; }
+        size_t n = src[si].iov_len - so;
+        if (dst[di].iov_len - dof < n) n = dst[di].iov_len - dof;
+        zuc_crypt_stream(ctx, rest, used, static_cast<const uint8_t *>(src[si].iov_base) + so,
+                         static_cast<uint8_t *>(dst[di].iov_base) + dof, n);
+        so += n;
+        dof += n;
+        srcLen -= n;
+    }
+    return true;
+}
+
+// 分散/聚集加解密: 输入和输出各是一个iovec数组, 分段方式可以不同, 总长度须相同(否则返回false);
+// 原地加解密时两边传同一个数组. 一个密钥字跨越片段边界时, 剩余字节接着用于下一个片段,
+// 结果与把所有片段拼起来调用一次zuc_encrypt相同.
+inline bool zuc_encrypt_iov(ZUC_CTX &ctx, const struct iovec *src, size_t srcCount,
+                            const struct iovec *dst, size_t dstCount) {
+    uint8_t rest[4];
+    unsigned used = 4;
+    return zuc_crypt_iov(ctx, rest, &used, src, srcCount, dst, dstCount);
+}
+
+// 流式ZUC: 对象里只保存LFSR/FSM状态和不到一个字的剩余密钥流, 可以任意切分地多次调用,
+// 结果与一次性加密整条消息逐字节相同; 不做堆分配, 析构时清零状态.
+//
+// 用法: ZUCCipher zuc(key, iv);
+//       zuc.crypt(p1, c1, n1); zuc.crypt(p2, c2, n2); ...   // in与out可以相同
+//       ZUC-256: ZUCCipher zuc; zuc.init256(key32, iv25); ...
+class ZUCCipher {
+public:
+    ZUCCipher() : used(4) { std::memset(&ctx, 0, sizeof(ctx)); }
+    ZUCCipher(const uint8_t key[16], const uint8_t iv[16]) { init(key, iv); }
+    ~ZUCCipher() {
+        volatile uint8_t *p = reinterpret_cast<volatile uint8_t *>(&ctx);
+        for (size_t i = 0; i < sizeof(ctx); ++i) p[i] = 0;
+        p = rest;
+        for (size_t i = 0; i < sizeof(rest); ++i) p[i] = 0;
+    }
+
+    ZUCCipher(const ZUCCipher &) = delete;
+    ZUCCipher &operator=(const ZUCCipher &) = delete;
+
+    // 装载新的密钥和IV, 丢弃之前的余量
+    void init(const uint8_t key[16], const uint8_t iv[16]) {
+        zuc_init(ctx, key, iv);
+        used = 4;
+    }
+
+    // 换成ZUC-256的32字节密钥和25字节IV
+    void init256(const uint8_t key[32], const uint8_t iv[25]) {
+        zuc256_init(ctx, key, iv);
+        used = 4;
+    }
+
+    void crypt(const uint8_t *input, uint8_t *output, size_t len) {
+        zuc_crypt_stream(ctx, rest, &used, input, output, len);
+    }
+
+    bool crypt_iov(const struct iovec *src, size_t srcCount, const struct iovec *dst, size_t dstCount) {
+        return zuc_crypt_iov(ctx, rest, &used, src, srcCount, dst, dstCount);
+    }
+
+    // 直接输出密钥流字节, 与crypt共用同一条密钥流
+    void keystream(uint8_t *out, size_t len) {
+        std::memset(out, 0, len);
+        crypt(out, out, len);
+    }
+
+private:
+    ZUC_CTX ctx;
+    uint8_t rest[4];
+    unsigned used;
+};
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "zuc256.h"
+#include "zuc_mb.h"
+
+static void fromHex(const char* hex, uint8_t* out) {
+    for (size_t i = 0; hex[2 * i]; ++i) {
+        unsigned v;
+        sscanf(hex + 2 * i, "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+}
+
+// 逐比特的ZUC-256 MAC, 用于对照
+static void mac_bitwise(const uint8_t key[32], const uint8_t iv[25], const uint8_t* msg, size_t bits,
+                        uint8_t* tag, int tagBits) {
+    ZUC_CTX ctx;
+    zuc256_init(ctx, key, iv, tagBits);
+    size_t words = (2 * tagBits + bits + 31) / 32 + 1;
+    std::vector<uint32_t> z(words);
+    zuc_generate_keystream(ctx, z.data(), (int)words);
+    auto window = [&](size_t i) {
+        return i % 32 == 0 ? z[i / 32] : (z[i / 32] << (i % 32)) | (z[i / 32 + 1] >> (32 - i % 32));
+    };
+    uint32_t t[4];
+    for (int j = 0; j < tagBits / 32; ++j) t[j] = z[j];
+    for (size_t i = 0; i < bits; ++i) {
+        if (msg[i / 8] & (0x80 >> (i % 8))) {
+            for (int j = 0; j < tagBits / 32; ++j) t[j] ^= window(tagBits + i + 32 * j);
+        }
+    }
+    for (int j = 0; j < tagBits / 32; ++j) {
+        t[j] ^= window(tagBits + bits + 32 * j);
+        for (int b = 0; b < 4; ++b) tag[4 * j + b] = (uint8_t)(t[j] >> (24 - 8 * b));
+    }
+}
+
+int main() {
+    // 论文中的测试向量: 密钥全0/IV全0, 密钥全0xff/IV前17字节0xff、后8个6比特值0x3f
+    uint8_t key[2][32], iv[2][25];
+    std::memset(key[0], 0, 32);
+    std::memset(iv[0], 0, 25);
+    std::memset(key[1], 0xff, 32);
+    std::memset(iv[1], 0xff, 17);
+    std::memset(iv[1] + 17, 0x3f, 8);
+
+    const char* stream[2] = {"58d03ad62e032ce2dafc683a39bdcb03", "3356cbaed1a1c18b6baa4ffe343f777c"};
+    for (int v = 0; v < 2; ++v) {
+        ZUCCipher zuc;
+        zuc.init256(key[v], iv[v]);
+        uint8_t ks[16], expect[16];
+        zuc.keystream(ks, 16);
+        fromHex(stream[v], expect);
+        printf("密钥流 测试%d: %s\n", v + 1, std::memcmp(ks, expect, 16) == 0 ? "一致" : "不一致!");
+    }
+
+    struct { int v; size_t bits; uint8_t fill; int tagBits; const char* tag; } macs[] = {
+        {0, 400, 0x00, 32, "9b972a74"},
+        {0, 400, 0x00, 64, "673e54990034d38c"},
+        {0, 400, 0x00, 128, "d85e54bbcb9600967084c952a1654b26"},
+        {0, 4000, 0x11, 32, "8754f5cf"},
+        {0, 4000, 0x11, 64, "130dc225e72240cc"},
+        {0, 4000, 0x11, 128, "df1e8307b31cc62beca1ac6f8190c22f"},
+        {1, 400, 0x00, 32, "1f3079b4"},
+        {1, 400, 0x00, 64, "8c71394d39957725"},
+        {1, 400, 0x00, 128, "a35bb274b567c48b28319f111af34fbd"},
+        {1, 4000, 0x11, 32, "5c7c8b88"},
+        {1, 4000, 0x11, 64, "ea1dee544bb6223b"},
+        {1, 4000, 0x11, 128, "3a83b554be408ca5494124ed9d473205"},
+    };
+    int failures = 0;
+    for (auto& m : macs) {
+        std::vector<uint8_t> msg(m.bits / 8, m.fill);
+        uint8_t tag[16], expect[16];
+        fromHex(m.tag, expect);
+        zuc256_mac(key[m.v], iv[m.v], msg.data(), m.bits, tag, m.tagBits);
+        if (std::memcmp(tag, expect, m.tagBits / 8) != 0) ++failures;
+    }
+    printf("MAC 测试向量(32/64/128位): %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // 随机长度与逐比特实现比较
+    std::mt19937 gen(2024);
+    failures = 0;
+    for (int round = 0; round < 600; ++round) {
+        uint8_t k[32], v[25];
+        for (auto& b : k) b = (uint8_t)gen();
+        for (auto& b : v) b = (uint8_t)gen();
+        size_t bits = gen() % 3000;
+        std::vector<uint8_t> msg((bits + 7) / 8 + 1);
+        for (auto& b : msg) b = (uint8_t)gen();
+        int tagBits = 32 << (round % 3);
+        uint8_t a[16], b[16], c[16];
+        mac_bitwise(k, v, msg.data(), bits, a, tagBits);
+        zuc256_mac(k, v, msg.data(), bits, b, tagBits, zuc_3gpp::GENERIC);
+        zuc256_mac(k, v, msg.data(), bits, c, tagBits);
+        if (std::memcmp(a, b, tagBits / 8) || std::memcmp(a, c, tagBits / 8)) ++failures;
+    }
+    printf("随机长度与逐比特实现比较: %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // 多路批量引擎: 与逐条ZUCCipher比较, 并对比吞吐
+    const size_t packets = 20000;
+    std::vector<uint8_t[32]> keys(packets);
+    std::vector<uint8_t[25]> ivs(packets);
+    std::vector<size_t> lens(packets);
+    std::vector<std::vector<uint8_t>> plain(packets), expect(packets), out(packets);
+    std::vector<const uint8_t*> in(packets);
+    std::vector<uint8_t*> outp(packets);
+    size_t total = 0;
+    for (size_t i = 0; i < packets; ++i) {
+        for (auto& b : keys[i]) b = (uint8_t)gen();
+        for (auto& b : ivs[i]) b = (uint8_t)gen();
+        lens[i] = (i % 4 == 0) ? 1500 : 40 + gen() % 200;
+        total += lens[i];
+        plain[i].resize(lens[i]);
+        for (auto& b : plain[i]) b = (uint8_t)gen();
+        expect[i].resize(lens[i]);
+        out[i].resize(lens[i]);
+        in[i] = plain[i].data();
+        outp[i] = out[i].data();
+        ZUCCipher zuc;
+        zuc.init256(keys[i], ivs[i]);
+        zuc.crypt(plain[i].data(), expect[i].data(), lens[i]);
+    }
+    const struct { const char* name; int backend; } backends[] = {
+        {"标量", zuc_mb::SCALAR}, {"AVX2 8路", zuc_mb::AVX2}, {"AVX-512 16路", zuc_mb::AVX512}};
+    for (auto& b : backends) {
+        if (b.backend > zuc_mb::detect_backend()) continue;
+        auto start = std::chrono::steady_clock::now();
+        zuc256_crypt_batch(keys.data(), ivs.data(), in.data(), outp.data(), lens.data(), packets, b.backend);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("ZUC-256 %-14s %6.2f M包/s %8.1f MB/s  %s\n", b.name, packets / sec / 1e6, total / sec / 1e6,
+               out == expect ? "与逐条加密一致" : "结果不一致!");
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+// ZUC-256: 32字节密钥, 25字节IV. 装载方式和常数与ZUC-128不同(见zuc.h的zuc256_load_key),
+// 之后的32轮初始化、环形LFSR、F函数、流式加密(ZUCCipher::init256)和多路批量引擎(zuc256_crypt_batch)
+// 与ZUC-128共用同一套代码.
+//
+// 这里补上ZUC-256的MAC, 标签长度t为32/64/128位, 每种长度装载不同的常数:
+//   Tag = 密钥流的前t比特; 对消息第i比特为1的位置, Tag ^= 从密钥流第t+i比特开始的t比特窗口;
+//   最后 Tag ^= 从第t+l比特开始的窗口(l为消息比特数).
+// t比特窗口拆成t/32个32比特窗口, 每个都和EIA3一样按消息字计算(PCLMUL或常数时间的按位掩码),
+// 只是密钥流的起点错开t/32+j个字.
+//
+// 用法: uint8_t tag[16]; zuc256_mac(key, iv, msg, lengthBits, tag, 128);
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "zuc.h"
+#include "zuc_eea3.h"
+
+// 对msg的前lengthBits比特计算tagBits(32/64/128)位MAC, 以大端写入tag; tagBits不合法时返回false.
+// backend含义同zuc_eia3
+inline bool zuc256_mac(const uint8_t key[32], const uint8_t iv[25], const uint8_t *msg, size_t lengthBits,
+                       uint8_t *tag, int tagBits, int backend = zuc_3gpp::AUTO) {
+    using namespace zuc_3gpp;
+    if (tagBits != 32 && tagBits != 64 && tagBits != 128) return false;
+    static const bool clmulDetected = has_clmul();
+    bool clmul = clmulDetected && (backend == AUTO || backend == CLMUL);
+#ifndef ZUC_EIA3_X86
+    (void)clmul;
+#endif
+
+    ZUC_CTX ctx;
+    zuc256_init(ctx, key, iv, tagBits);
+    const int T = tagBits / 32;
+
+    size_t fullWords = lengthBits / 32;
+    unsigned tailBits = (unsigned)(lengthBits % 32);
+    size_t words = fullWords + (tailBits ? 1 : 0);
+
+    // buf[x] = k[base + x]; 处理base起的n个消息字要用到k[base .. base + n + 2T - 1]
+    uint32_t buf[ZUC_BATCH_WORDS + 8];
+    zuc_generate_keystream(ctx, buf, 2 * T);
+    uint32_t t[4];
+    for (int j = 0; j < T; ++j) t[j] = buf[j];
+
+    for (size_t base = 0; base < words; base += ZUC_BATCH_WORDS) {
+        int n = words - base < ZUC_BATCH_WORDS ? (int)(words - base) : ZUC_BATCH_WORDS;
+        zuc_generate_keystream(ctx, buf + 2 * T, n);
+        int full = base + n <= fullWords ? n : n - 1;
+        const uint8_t *p = msg + 4 * base;
+        for (int j = 0; j < T; ++j) {
+#ifdef ZUC_EIA3_X86
+            if (clmul) t[j] ^= mac_words_clmul(p, buf + T + j, full);
+            else
+#endif
+                t[j] ^= mac_words_generic(p, buf + T + j, full);
+        }
+        if (full < n) {
+            uint32_t m = 0;
+            for (unsigned b = 0; b < (tailBits + 7) / 8; ++b) m |= (uint32_t)p[4 * full + b] << (24 - 8 * b);
+            m &= 0xFFFFFFFFu << (32 - tailBits);
+            for (int j = 0; j < T; ++j) t[j] ^= mac_word(m, buf[T + j + full], buf[T + j + full + 1]);
+        }
+        std::memmove(buf, buf + n, sizeof(uint32_t) * 2 * T);
+    }
+
+    // 此时buf[x] = k[words + x]; 结尾窗口从第t+l比特开始
+    for (int j = 0; j < T; ++j) {
+        uint32_t w = tailBits ? (buf[T + j - 1] << tailBits) | (buf[T + j] >> (32 - tailBits)) : buf[T + j];
+        t[j] ^= w;
+        tag[4 * j] = (uint8_t)(t[j] >> 24);
+        tag[4 * j + 1] = (uint8_t)(t[j] >> 16);
+        tag[4 * j + 2] = (uint8_t)(t[j] >> 8);
+        tag[4 * j + 3] = (uint8_t)t[j];
+    }
+    return true;
+}
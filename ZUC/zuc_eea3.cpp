@@ -0,0 +1,153 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "zuc_eea3.h"
+
+static void fromHex(const char* hex, uint8_t* out) {
+    for (size_t i = 0; hex[2 * i]; ++i) {
+        unsigned v;
+        sscanf(hex + 2 * i, "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+}
+
+// 规范中逐比特的EIA3, 用于对照
+static uint32_t eia3_bitwise(const uint8_t ik[16], uint32_t count, uint8_t bearer, uint8_t direction,
+                             const uint8_t* msg, size_t lengthBits) {
+    uint8_t iv[16];
+    zuc_eia3_iv(count, bearer, direction, iv);
+    ZUC_CTX ctx;
+    zuc_init(ctx, ik, iv);
+    size_t L = (lengthBits + 31) / 32 + 2;
+    std::vector<uint32_t> z(L);
+    zuc_generate_keystream(ctx, z.data(), (int)L);
+    auto window = [&](size_t i) {
+        return i % 32 == 0 ? z[i / 32] : (z[i / 32] << (i % 32)) | (z[i / 32 + 1] >> (32 - i % 32));
+    };
+    uint32_t t = 0;
+    for (size_t i = 0; i < lengthBits; ++i) {
+        if (msg[i / 8] & (0x80 >> (i % 8))) t ^= window(i);
+    }
+    t ^= window(lengthBits);
+    return t ^ z[L - 1];
+}
+
+// 按规范逐字生成密钥流再异或的EEA3, 最后一个字节超出长度的比特清零; 用于对照
+static void eea3_reference(const uint8_t ck[16], uint32_t count, uint8_t bearer, uint8_t direction,
+                           const uint8_t* in, uint8_t* out, size_t lengthBits) {
+    uint8_t iv[16];
+    zuc_eea3_iv(count, bearer, direction, iv);
+    ZUC_CTX ctx;
+    zuc_init(ctx, ck, iv);
+    size_t L = (lengthBits + 31) / 32;
+    std::vector<uint32_t> z(L + 1);
+    zuc_generate_keystream(ctx, z.data(), (int)L);
+    for (size_t i = 0; i < (lengthBits + 7) / 8; ++i) out[i] = in[i] ^ (uint8_t)(z[i / 4] >> (24 - 8 * (i % 4)));
+    if (lengthBits % 8) out[(lengthBits + 7) / 8 - 1] &= (uint8_t)(0xFF << (8 - lengthBits % 8));
+}
+
+int main() {
+    // EEA3测试集1(193比特, 最后一个字节只用1比特)与测试集2(800比特)
+    struct { const char* key; uint32_t count; uint8_t bearer, direction; size_t bits; const char* plain; const char* cipher; } eea[] = {
+        {"173d14ba5003731d7a60049470f00a29", 0x66035492, 0x0f, 0, 193,
+         "6cf65340735552ab0c9752fa6f9025fe0bd675d9005875b200000000",
+         "a6c85fc66afb8533aafc2518dfe784940ee1e4b030238cc800000000"},
+        {"e5bd3ea0eb55ade866c6ac58bd54302a", 0x00056823, 0x18, 1, 800,
+         "14a8ef693d678507bbe7270a7f67ff5006c3525b9807e467c4e56000ba338f5d4295590367518222"
+         "46c80d3b38f07f4be2d8ff5805f5132229bde93bbbdcaf382bf1ee972fbf9977bada8945847a2a6c"
+         "9ad34a667554e04d1f7fa2c33241bd8f01ba220d",
+         "131d43e0dea1be5c5a1bfd971d852cbf712d7b4f57961fea3208afa8bca433f456ad09c7417e58bc69cf8866"
+         "d1353f74865e80781d202dfb3ecff7fcbc3b190fe82a204ed0e350fc0f6f2613b2f2bca6df5a473a57a4a00d"
+         "985ebad880d6f23864a07b01"},
+    };
+    for (size_t s = 0; s < sizeof(eea) / sizeof(eea[0]); ++s) {
+        uint8_t ck[16], plain[128], cipher[128], out[128];
+        fromHex(eea[s].key, ck);
+        fromHex(eea[s].plain, plain);
+        fromHex(eea[s].cipher, cipher);
+        size_t bytes = (eea[s].bits + 7) / 8;
+        zuc_eea3(ck, eea[s].count, eea[s].bearer, eea[s].direction, plain, out, eea[s].bits);
+        bool ok = std::memcmp(out, cipher, bytes) == 0;
+        zuc_eea3(ck, eea[s].count, eea[s].bearer, eea[s].direction, out, out, eea[s].bits);
+        ok = ok && std::memcmp(out, plain, bytes) == 0;
+        printf("EEA3 测试集%zu: %s\n", s + 1, ok ? "一致" : "不一致!");
+    }
+
+    // EIA3测试集1~3
+    struct { const char* key; uint32_t count; uint8_t bearer, direction; size_t bits; const char* msg; uint32_t mac; } sets[] = {
+        {"00000000000000000000000000000000", 0, 0, 0, 1, "00000000", 0xc8a9595e},
+        {"47054125561eb2dda94059da05097850", 0x561eb2dd, 0x14, 0, 90, "000000000000000000000000", 0x6719a088},
+        {"c9e6cec4607c72db000aefa88385ab0a", 0xa94059da, 0x0a, 1, 577,
+         "983b41d47d780c9e1ad11d7eb70391b1de0b35da2dc62f83e7b78d6306ca0ea07e941b7be91348f9fcb170e2217fecd9"
+         "7f9f68adb16e5d7d21e569d280ed775cebde3f4093c5388100000000", 0xfae8ff0b},
+    };
+    for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); ++s) {
+        uint8_t ik[16], msg[128];
+        fromHex(sets[s].key, ik);
+        fromHex(sets[s].msg, msg);
+        uint32_t g = zuc_eia3(ik, sets[s].count, sets[s].bearer, sets[s].direction, msg, sets[s].bits, zuc_3gpp::GENERIC);
+        uint32_t c = zuc_eia3(ik, sets[s].count, sets[s].bearer, sets[s].direction, msg, sets[s].bits);
+        printf("EIA3 测试集%zu: %08x %s\n", s + 1, c, g == sets[s].mac && c == sets[s].mac ? "一致" : "不一致!");
+    }
+
+    // 随机长度(含不是8的倍数的长度)与逐字参考实现比较
+    std::mt19937 gen(2024);
+    int failures = 0;
+    for (int round = 0; round < 2000; ++round) {
+        uint8_t ck[16];
+        for (auto& b : ck) b = (uint8_t)gen();
+        size_t bits = 1 + gen() % 12000;
+        std::vector<uint8_t> in((bits + 7) / 8), expect(in.size()), got(in.size());
+        for (auto& b : in) b = (uint8_t)gen();
+        uint32_t count = gen();
+        uint8_t bearer = gen() % 32, direction = gen() % 2;
+        eea3_reference(ck, count, bearer, direction, in.data(), expect.data(), bits);
+        zuc_eea3(ck, count, bearer, direction, in.data(), got.data(), bits);
+        if (got != expect) ++failures;
+    }
+    printf("EEA3随机长度与参考实现比较: %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // EIA3随机长度与逐比特实现比较
+    failures = 0;
+    for (int round = 0; round < 2000; ++round) {
+        uint8_t ik[16];
+        for (auto& b : ik) b = (uint8_t)gen();
+        size_t bits = gen() % 3000;
+        std::vector<uint8_t> msg((bits + 7) / 8);
+        for (auto& b : msg) b = (uint8_t)gen();
+        uint32_t count = gen();
+        uint8_t bearer = gen() % 32, direction = gen() % 2;
+        uint32_t expect = eia3_bitwise(ik, count, bearer, direction, msg.data(), bits);
+        if (zuc_eia3(ik, count, bearer, direction, msg.data(), bits, zuc_3gpp::GENERIC) != expect ||
+            zuc_eia3(ik, count, bearer, direction, msg.data(), bits) != expect) {
+            ++failures;
+        }
+    }
+    printf("EIA3随机长度与逐比特实现比较: %s\n", failures == 0 ? "全部一致" : "有不一致!");
+
+    // 吞吐: 1500字节信令包的MAC
+    const size_t packets = 20000, size = 1500;
+    std::vector<uint8_t> pool(packets * size);
+    for (auto& b : pool) b = (uint8_t)gen();
+    uint8_t ik[16] = {0};
+    auto bench = [&](const char* name, auto fn) {
+        uint32_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t p = 0; p < packets; ++p) sink ^= fn(&pool[p * size]);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-10s %8.1f MB/s (校验%08x)\n", name, pool.size() / sec / 1e6, sink);
+    };
+    bench("逐比特", [&](const uint8_t* m) { return eia3_bitwise(ik, 1, 2, 0, m, size * 8); });
+    bench("按字", [&](const uint8_t* m) { return zuc_eia3(ik, 1, 2, 0, m, size * 8, zuc_3gpp::GENERIC); });
+    if (zuc_3gpp::has_clmul()) {
+        bench("PCLMUL", [&](const uint8_t* m) { return zuc_eia3(ik, 1, 2, 0, m, size * 8, zuc_3gpp::CLMUL); });
+    }
+    bench("EEA3", [&](const uint8_t* m) {
+        zuc_eea3(ik, 1, 2, 0, m, const_cast<uint8_t*>(m), size * 8);
+        return (uint32_t)m[0];
+    });
+    return 0;
+}
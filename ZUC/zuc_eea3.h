@@ -0,0 +1,194 @@
+#pragma once
+
+// 基于ZUC_CTX的128-EEA3(机密性)与128-EIA3(完整性), 按3GPP的EEA3/EIA3规范:
+// 由COUNT/BEARER/DIRECTION构造IV, 消息长度以比特计.
+//
+// EIA3的MAC是 T = XOR{ z_i : 消息第i比特为1 }, 其中z_i是从密钥流第i比特开始的32比特窗口.
+// 规范里逐比特循环; 这里按32比特的消息字处理: 一个字m对应的贡献是
+//   XOR_j m_j * ((K << j) >> 32), K = 本字和下一个字的密钥流拼成的64位数,
+// 即rev32(m)与K的无进位乘积的第32~63位. 有PCLMUL时每个消息字一次CLMUL
+// (每16字节用两次PSHUFB把字节按位反转); 否则用按位掩码的常数时间循环, 不读任何按消息取值的表.
+//
+// 用法: zuc_eea3(ck, count, bearer, direction, in, out, lengthBits);
+//       uint32_t mac = zuc_eia3(ik, count, bearer, direction, msg, lengthBits);
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "zuc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ZUC_EIA3_X86 1
+#include <immintrin.h>
+#endif
+
+namespace zuc_3gpp {
+
+enum Backend { AUTO = 0, GENERIC = 1, CLMUL = 2 };
+
+inline uint32_t load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// 一个消息字的贡献, 常数时间
+inline uint32_t mac_word(uint32_t m, uint32_t k0, uint32_t k1) {
+    uint64_t K = ((uint64_t)k0 << 32) | k1;
+    uint32_t t = 0;
+    for (int j = 0; j < 32; ++j) {
+        uint32_t mask = 0 - ((m >> (31 - j)) & 1);
+        t ^= (uint32_t)(K >> (32 - j)) & mask;
+    }
+    return t;
+}
+
+// msg的n个完整字, 密钥流ks[0..n]
+inline uint32_t mac_words_generic(const uint8_t *msg, const uint32_t *ks, int n) {
+    uint32_t t = 0;
+    for (int i = 0; i < n; ++i) t ^= mac_word(load_be32(msg + 4 * i), ks[i], ks[i + 1]);
+    return t;
+}
+
+#ifdef ZUC_EIA3_X86
+alignas(16) static const uint8_t REV_LO[16] = {0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+                                               0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF};
+alignas(16) static const uint8_t REV_HI[16] = {0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0,
+                                               0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0};
+
+// 每个字节按位反转后按小端读出, 正好是大端消息字的rev32
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i reverse_bits(__m128i x) {
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i lo = _mm_shuffle_epi8(_mm_load_si128((const __m128i *)REV_HI), _mm_and_si128(x, nibble));
+    __m128i hi = _mm_shuffle_epi8(_mm_load_si128((const __m128i *)REV_LO), _mm_and_si128(_mm_srli_epi16(x, 4), nibble));
+    return _mm_or_si128(lo, hi);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static uint32_t mac_words_clmul(const uint8_t *msg, const uint32_t *ks, int n) {
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i r = reverse_bits(_mm_loadu_si128((const __m128i *)(msg + 4 * i)));
+        // 四个消息字各配一个64位密钥流窗口
+        __m128i k01 = _mm_set_epi64x((long long)(((uint64_t)ks[i + 1] << 32) | ks[i + 2]),
+                                     (long long)(((uint64_t)ks[i] << 32) | ks[i + 1]));
+        __m128i k23 = _mm_set_epi64x((long long)(((uint64_t)ks[i + 3] << 32) | ks[i + 4]),
+                                     (long long)(((uint64_t)ks[i + 2] << 32) | ks[i + 3]));
+        __m128i r0 = _mm_and_si128(r, _mm_set_epi32(0, 0, 0, -1));
+        __m128i r1 = _mm_srli_epi64(r, 32);
+        __m128i r23 = _mm_unpackhi_epi64(r, r);
+        __m128i r2 = _mm_and_si128(r23, _mm_set_epi32(0, 0, 0, -1));
+        __m128i r3 = _mm_srli_epi64(r23, 32);
+        acc = _mm_xor_si128(acc, _mm_clmulepi64_si128(r0, k01, 0x00));
+        acc = _mm_xor_si128(acc, _mm_clmulepi64_si128(r1, k01, 0x10));
+        acc = _mm_xor_si128(acc, _mm_clmulepi64_si128(r2, k23, 0x00));
+        acc = _mm_xor_si128(acc, _mm_clmulepi64_si128(r3, k23, 0x10));
+    }
+    // 各乘积的第32~63位异或起来就是T
+    uint32_t t = (uint32_t)((uint64_t)_mm_cvtsi128_si64(acc) >> 32);
+    for (; i < n; ++i) t ^= mac_word(load_be32(msg + 4 * i), ks[i], ks[i + 1]);
+    return t;
+}
+#endif
+
+inline bool has_clmul() {
+#ifdef ZUC_EIA3_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+}
+
+} // namespace zuc_3gpp
+
+// EEA3的IV: COUNT(大端) || BEARER || DIRECTION || 0..., 后8字节重复前8字节
+inline void zuc_eea3_iv(uint32_t count, uint8_t bearer, uint8_t direction, uint8_t iv[16]) {
+    iv[0] = (uint8_t)(count >> 24);
+    iv[1] = (uint8_t)(count >> 16);
+    iv[2] = (uint8_t)(count >> 8);
+    iv[3] = (uint8_t)count;
+    iv[4] = (uint8_t)(((bearer & 0x1F) << 3) | ((direction & 1) << 2));
+    iv[5] = iv[6] = iv[7] = 0;
+    std::memcpy(iv + 8, iv, 8);
+}
+
+// EIA3的IV: DIRECTION不放在第4字节, 而是异或进第8和第14字节的最高位
+inline void zuc_eia3_iv(uint32_t count, uint8_t bearer, uint8_t direction, uint8_t iv[16]) {
+    iv[0] = (uint8_t)(count >> 24);
+    iv[1] = (uint8_t)(count >> 16);
+    iv[2] = (uint8_t)(count >> 8);
+    iv[3] = (uint8_t)count;
+    iv[4] = (uint8_t)((bearer & 0x1F) << 3);
+    iv[5] = iv[6] = iv[7] = 0;
+    std::memcpy(iv + 8, iv, 8);
+    iv[8] ^= (uint8_t)((direction & 1) << 7);
+    iv[14] ^= (uint8_t)((direction & 1) << 7);
+}
+
+// 128-EEA3: 加密lengthBits比特, in/out各占(lengthBits+7)/8字节, 可以是同一缓冲区;
+// 最后一个字节里超出长度的低位在输出中清零
+inline void zuc_eea3(const uint8_t ck[16], uint32_t count, uint8_t bearer, uint8_t direction,
+                     const uint8_t *input, uint8_t *output, size_t lengthBits) {
+    uint8_t iv[16];
+    zuc_eea3_iv(count, bearer, direction, iv);
+    ZUC_CTX ctx;
+    zuc_init(ctx, ck, iv);
+    uint8_t rest[4];
+    unsigned used = 4;
+    size_t bytes = (lengthBits + 7) / 8;
+    zuc_crypt_stream(ctx, rest, &used, input, output, bytes);
+    if (lengthBits % 8) output[bytes - 1] &= (uint8_t)(0xFF << (8 - lengthBits % 8));
+}
+
+// 128-EIA3: 对msg的前lengthBits比特计算32位MAC(msg占(lengthBits+7)/8字节).
+// backend为AUTO时自动检测PCLMUL, 也可指定zuc_3gpp::GENERIC/CLMUL用于对比测试(CPU不支持PCLMUL时CLMUL按GENERIC处理)
+inline uint32_t zuc_eia3(const uint8_t ik[16], uint32_t count, uint8_t bearer, uint8_t direction,
+                         const uint8_t *msg, size_t lengthBits, int backend = zuc_3gpp::AUTO) {
+    using namespace zuc_3gpp;
+    static const bool clmulDetected = has_clmul();
+    bool clmul = clmulDetected && (backend == AUTO || backend == CLMUL);
+#ifndef ZUC_EIA3_X86
+    (void)clmul;
+#endif
+
+    uint8_t iv[16];
+    zuc_eia3_iv(count, bearer, direction, iv);
+    ZUC_CTX ctx;
+    zuc_init(ctx, ik, iv);
+
+    size_t fullWords = lengthBits / 32;
+    unsigned tailBits = (unsigned)(lengthBits % 32);
+    size_t words = fullWords + (tailBits ? 1 : 0);
+
+    // ks[0]是上一批留下的最后一个密钥字, 每个消息字需要本字和下一个字
+    uint32_t ks[ZUC_BATCH_WORDS + 1];
+    zuc_generate_keystream(ctx, ks, 1);
+    uint32_t t = 0, prev = 0;
+    for (size_t base = 0; base < words; base += ZUC_BATCH_WORDS) {
+        int n = words - base < ZUC_BATCH_WORDS ? (int)(words - base) : ZUC_BATCH_WORDS;
+        zuc_generate_keystream(ctx, ks + 1, n);
+        int full = base + n <= fullWords ? n : n - 1;
+        const uint8_t *p = msg + 4 * base;
+#ifdef ZUC_EIA3_X86
+        if (clmul) t ^= mac_words_clmul(p, ks, full);
+        else
+#endif
+            t ^= mac_words_generic(p, ks, full);
+        if (full < n) {
+            // 最后一个不满32比特的字: 只读实际存在的字节, 超出长度的比特视为0
+            uint32_t m = 0;
+            for (unsigned b = 0; b < (tailBits + 7) / 8; ++b) m |= (uint32_t)p[4 * full + b] << (24 - 8 * b);
+            m &= 0xFFFFFFFFu << (32 - tailBits);
+            t ^= mac_word(m, ks[full], ks[full + 1]);
+        }
+        prev = ks[n - 1];
+        ks[0] = ks[n];
+    }
+
+    // 此时ks[0] = k[words], prev = k[words-1]; 再取k[words+1]
+    uint32_t last;
+    zuc_generate_keystream(ctx, &last, 1);
+    uint32_t zLength = tailBits ? (prev << tailBits) | (ks[0] >> (32 - tailBits)) : ks[0];
+    return t ^ zLength ^ last;
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+// 多路并行ZUC: 把8条(AVX2)或16条(AVX-512)互相独立的(密钥, IV)放进向量寄存器的不同通道,
+// 同步跑32轮初始化和密钥流生成. 短报文的耗时主要在初始化上, 单条流内部又是串行的,
+// 只有跨流并行才能用满向量单元, 适合基站上大量承载各自加密短包的场景.
+//
+// S0/S1查表用向量gather(每个S盒变换4次, 表项预先扩展成32位); 模2^31-1的加法和循环移位
+// 都是逐通道的普通向量运算. LFSR用16个向量组成的环, 16个时钟完全展开后下标都是常量.
+//
+// 用法: zuc_crypt_batch(keys, ivs, in, out, lens, n);      ZUC-256: zuc256_crypt_batch(...)
+// 各条流的长度可以不同: 按长度排序后每批取相邻的8或16条, 已结束的通道继续空转但不再输出.
+// 运行时检测CPU, 依次选择AVX-512 / AVX2 / 标量(ZUCCipher)实现, 结果与逐条调用zuc_encrypt完全一致.
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "zuc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ZUC_MB_X86 1
+#include <immintrin.h>
+#endif
+
+namespace zuc_mb {
+
+typedef uint32_t u32x8 __attribute__((vector_size(32)));
+typedef uint32_t u32x16 __attribute__((vector_size(64)));
+
+// gather用的32位S盒
+struct SboxTables {
+    uint32_t s0[256], s1[256];
+    SboxTables() {
+        for (int i = 0; i < 256; ++i) {
+            s0[i] = S0[i];
+            s1[i] = S1[i];
+        }
+    }
+};
+
+inline const SboxTables SBOX32;
+
+// 向量版本用宏实现, 避免向量类型作为函数参数/返回值(未开启AVX的上下文里会改变调用约定)
+#define ZUC_MB_ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define ZUC_MB_ROTL31(x, n) ((((x) << (n)) | ((x) >> (31 - (n)))) & 0x7FFFFFFF)
+#define ZUC_MB_ADD31(a, b) ({ auto c_ = (a) + (b); (c_ & 0x7FFFFFFF) + (c_ >> 31); })
+#define ZUC_MB_L1(x) ((x) ^ ZUC_MB_ROTL32(x, 2) ^ ZUC_MB_ROTL32(x, 10) ^ ZUC_MB_ROTL32(x, 18) ^ ZUC_MB_ROTL32(x, 24))
+#define ZUC_MB_L2(x) ((x) ^ ZUC_MB_ROTL32(x, 8) ^ ZUC_MB_ROTL32(x, 14) ^ ZUC_MB_ROTL32(x, 22) ^ ZUC_MB_ROTL32(x, 30))
+
+#ifdef ZUC_MB_X86
+template <typename Vec> struct Gather;
+
+template <> struct Gather<u32x8> {
+    static inline __attribute__((target("avx2"))) void run(u32x8& r, const uint32_t* t, const u32x8& idx) {
+        r = (u32x8)_mm256_i32gather_epi32((const int*)t, (__m256i)idx, 4);
+    }
+};
+
+template <> struct Gather<u32x16> {
+    static inline __attribute__((target("avx512f"))) void run(u32x16& r, const uint32_t* t, const u32x16& idx) {
+        r = (u32x16)_mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, (__m512i)idx, (const int*)t, 4);
+    }
+};
+
+// 各通道的S(w) = S0[w>>24] || S1[w>>16] || S0[w>>8] || S1[w]
+template <typename Vec>
+static inline __attribute__((always_inline)) void sbox_lanes(Vec& r, const Vec& w) {
+    Vec b3, b2, b1, b0;
+    Gather<Vec>::run(b3, SBOX32.s0, w >> 24);
+    Gather<Vec>::run(b2, SBOX32.s1, (w >> 16) & 0xFF);
+    Gather<Vec>::run(b1, SBOX32.s0, (w >> 8) & 0xFF);
+    Gather<Vec>::run(b0, SBOX32.s1, w & 0xFF);
+    r = (b3 << 24) | (b2 << 16) | (b1 << 8) | b0;
+}
+
+// 所有通道的ZUC状态; s[(head + i) % 16]为各通道的s_i, 时钟由16步展开的循环驱动, 这里head就是循环变量
+template <typename Vec>
+struct State {
+    Vec s[16];
+    Vec r1, r2;
+};
+
+// 相位为p的一个时钟(p在展开的循环里是常量), 给出F的输出w和X3; init为真时w>>1参与反馈
+template <typename Vec>
+static inline __attribute__((always_inline)) void clock_lanes(State<Vec>& st, unsigned p, bool init, Vec& w, Vec& x3) {
+    Vec* s = st.s;
+    Vec x0 = ((s[(p + 15) & 15] & 0x7FFF8000) << 1) | (s[(p + 14) & 15] & 0xFFFF);
+    Vec x1 = ((s[(p + 11) & 15] & 0xFFFF) << 16) | (s[(p + 9) & 15] >> 15);
+    Vec x2 = ((s[(p + 7) & 15] & 0xFFFF) << 16) | (s[(p + 5) & 15] >> 15);
+    x3 = ((s[(p + 2) & 15] & 0xFFFF) << 16) | (s[p & 15] >> 15);
+
+    w = (x0 ^ st.r1) + st.r2;
+    Vec w1 = st.r1 + x1;
+    Vec w2 = st.r2 ^ x2;
+    Vec u = (w1 << 16) | (w2 >> 16);
+    Vec v = (w2 << 16) | (w1 >> 16);
+    u = ZUC_MB_L1(u);
+    v = ZUC_MB_L2(v);
+    sbox_lanes<Vec>(st.r1, u);
+    sbox_lanes<Vec>(st.r2, v);
+
+    Vec f = s[p & 15];
+    f = ZUC_MB_ADD31(f, ZUC_MB_ROTL31(s[p & 15], 8));
+    f = ZUC_MB_ADD31(f, ZUC_MB_ROTL31(s[(p + 4) & 15], 20));
+    f = ZUC_MB_ADD31(f, ZUC_MB_ROTL31(s[(p + 10) & 15], 21));
+    f = ZUC_MB_ADD31(f, ZUC_MB_ROTL31(s[(p + 13) & 15], 17));
+    f = ZUC_MB_ADD31(f, ZUC_MB_ROTL31(s[(p + 15) & 15], 15));
+    if (init) f = ZUC_MB_ADD31(f, w >> 1);
+    s[p & 15] = f;
+}
+
+// 一个通道上的任务; lfsr为装载好密钥和IV的初始状态, ZUC-128和ZUC-256只在这里不同
+struct Lane {
+    uint32_t lfsr[LFSR_SIZE];
+    const uint8_t* in;
+    uint8_t* out;
+    size_t len;
+};
+
+template <typename Vec, int LANES>
+static inline __attribute__((always_inline)) void crypt_lanes(const Lane* lanes, int active) {
+    State<Vec> st;
+    for (int i = 0; i < 16; ++i) {
+        for (int k = 0; k < LANES; ++k) st.s[i][k] = k < active ? lanes[k].lfsr[i] : 0;
+    }
+    st.r1 = st.r1 ^ st.r1;
+    st.r2 = st.r1;
+
+    Vec w, x3;
+    // 32轮初始化 = 两个完整的16时钟周期, 之后head回到0
+    for (int round = 0; round < 2; ++round) {
+#pragma GCC unroll 16
+        for (unsigned p = 0; p < 16; ++p) clock_lanes<Vec>(st, p, true, w, x3);
+    }
+    // 工作模式的第一次输出丢弃; 之后的密钥流从相位1开始, 把环转回0以便继续按常量下标展开
+    clock_lanes<Vec>(st, 0, false, w, x3);
+    Vec rotated[16];
+    for (int i = 0; i < 16; ++i) rotated[i] = st.s[(i + 1) & 15];
+    for (int i = 0; i < 16; ++i) st.s[i] = rotated[i];
+
+    size_t maxLen = 0;
+    for (int k = 0; k < active; ++k) maxLen = std::max(maxLen, lanes[k].len);
+
+    // 每次生成16个密钥字(每通道64字节), 转置后按通道异或; 已结束的通道不再写出
+    alignas(64) uint32_t z[16][LANES];
+    for (size_t pos = 0; pos < maxLen; pos += 64) {
+#pragma GCC unroll 16
+        for (unsigned p = 0; p < 16; ++p) {
+            clock_lanes<Vec>(st, p, false, w, x3);
+            Vec zw = w ^ x3;
+            std::memcpy(z[p], &zw, sizeof(zw));
+        }
+        for (int k = 0; k < active; ++k) {
+            if (lanes[k].len <= pos) continue;
+            size_t n = std::min<size_t>(64, lanes[k].len - pos);
+            uint8_t ks[64];
+            for (int i = 0; i < 16; ++i) {
+                uint32_t v = z[i][k];
+                ks[4 * i] = (uint8_t)(v >> 24);
+                ks[4 * i + 1] = (uint8_t)(v >> 16);
+                ks[4 * i + 2] = (uint8_t)(v >> 8);
+                ks[4 * i + 3] = (uint8_t)v;
+            }
+            zuc_xor_bytes(lanes[k].out + pos, lanes[k].in + pos, ks, n);
+        }
+    }
+}
+
+// flatten把各层模板连同gather一起展开进带target属性的入口, 向量运算才会编译成对应指令集
+__attribute__((target("avx2"), flatten)) static void crypt_x8(const Lane* lanes, int active) {
+    crypt_lanes<u32x8, 8>(lanes, active);
+}
+
+__attribute__((target("avx512f"), flatten)) static void crypt_x16(const Lane* lanes, int active) {
+    crypt_lanes<u32x16, 16>(lanes, active);
+}
+#endif
+
+enum Backend { SCALAR = 1, AVX2 = 8, AVX512 = 16 };
+
+// 运行时检测CPU支持的最宽实现, 返回值即每批的通道数
+inline Backend detect_backend() {
+#ifdef ZUC_MB_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return AVX512;
+    if (__builtin_cpu_supports("avx2")) return AVX2;
+#endif
+    return SCALAR;
+}
+
+} // namespace zuc_mb
+
+#undef ZUC_MB_ROTL32
+#undef ZUC_MB_ROTL31
+#undef ZUC_MB_ADD31
+#undef ZUC_MB_L1
+#undef ZUC_MB_L2
+
+namespace zuc_mb {
+
+// 按长度排序后每LANES条一组调度; load(i, lfsr)装载第i条流的初始LFSR
+template <class Load>
+inline void crypt_batch(const uint8_t* const* in, uint8_t* const* out, const size_t* lens, size_t n,
+                        int lanesPerBatch, Load load) {
+#ifdef ZUC_MB_X86
+    // 同组流的长度接近, 空转的通道最少
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [lens](size_t a, size_t b) { return lens[a] < lens[b]; });
+
+    Lane lanes[16];
+    for (size_t start = 0; start < n; start += lanesPerBatch) {
+        int active = (int)std::min<size_t>(lanesPerBatch, n - start);
+        for (int k = 0; k < active; ++k) {
+            size_t idx = order[start + k];
+            load(idx, lanes[k].lfsr);
+            lanes[k].in = in[idx];
+            lanes[k].out = out[idx];
+            lanes[k].len = lens[idx];
+        }
+        // 不足半批时退回更窄的实现, 少空转一半通道
+        if (lanesPerBatch == AVX512 && active > 8) {
+            crypt_x16(lanes, active);
+        } else {
+            crypt_x8(lanes, active);
+        }
+    }
+#else
+    (void)in, (void)out, (void)lens, (void)n, (void)lanesPerBatch, (void)load;
+#endif
+}
+
+// 指定的实现超出CPU支持范围时降到检测到的最宽实现, 不会执行不支持的指令
+inline int lanes_per_batch(int backend) {
+    static const Backend detected = detect_backend();
+#ifdef ZUC_MB_X86
+    return backend ? std::min(backend, (int)detected) : detected;
+#else
+    (void)backend;
+    return SCALAR;
+#endif
+}
+
+} // namespace zuc_mb
+
+// 批量加解密n条独立的流: 第i条用keys[i]/ivs[i], 把in[i]的lens[i]字节加密到out[i](可以与in[i]相同).
+// backend为0时自动检测, 也可指定zuc_mb::SCALAR/AVX2/AVX512用于对比测试(CPU不支持时退回检测到的实现)
+inline void zuc_crypt_batch(const uint8_t (*keys)[16], const uint8_t (*ivs)[16], const uint8_t* const* in,
+                            uint8_t* const* out, const size_t* lens, size_t n, int backend = 0) {
+    int lanesPerBatch = zuc_mb::lanes_per_batch(backend);
+    if (lanesPerBatch == zuc_mb::SCALAR) {
+        ZUCCipher zuc;
+        for (size_t i = 0; i < n; ++i) {
+            zuc.init(keys[i], ivs[i]);
+            zuc.crypt(in[i], out[i], lens[i]);
+        }
+        return;
+    }
+    zuc_mb::crypt_batch(in, out, lens, n, lanesPerBatch,
+                        [&](size_t i, uint32_t* lfsr) { zuc_load_key(lfsr, keys[i], ivs[i]); });
+}
+
+// ZUC-256版本: 32字节密钥, 25字节IV, 其余与zuc_crypt_batch相同
+inline void zuc256_crypt_batch(const uint8_t (*keys)[32], const uint8_t (*ivs)[25], const uint8_t* const* in,
+                               uint8_t* const* out, const size_t* lens, size_t n, int backend = 0) {
+    int lanesPerBatch = zuc_mb::lanes_per_batch(backend);
+    if (lanesPerBatch == zuc_mb::SCALAR) {
+        ZUCCipher zuc;
+        for (size_t i = 0; i < n; ++i) {
+            zuc.init256(keys[i], ivs[i]);
+            zuc.crypt(in[i], out[i], lens[i]);
+        }
+        return;
+    }
+    zuc_mb::crypt_batch(in, out, lens, n, lanesPerBatch,
+                        [&](size_t i, uint32_t* lfsr) { zuc256_load_key(lfsr, keys[i], ivs[i]); });
+}